@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "alloc_guard.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace fchiggs {
+namespace {
+/**
+ *  The guard state of a thread. It is constant-initialized, so that
+ *  noteAllocation may read it at any time, even before main.
+ */
+struct GuardState {
+    unsigned int depth;
+    bool abort;
+    const char *what;
+    std::uint64_t count;
+};
+
+thread_local GuardState gstate = {0, false, nullptr, 0};
+
+}  // namespace
+
+void noteAllocation() {
+    GuardState &st = gstate;
+    if (st.depth == 0) { return; }
+    ++st.count;
+    if (st.abort) {
+        // stdio without buffering, since the heap must not be touched.
+        std::fputs("fchiggs: heap allocation in ", stderr);
+        std::fputs(st.what, stderr);
+        std::fputs("\n", stderr);
+        std::abort();
+    }
+}
+
+AllocGuardMode allocGuardMode() {
+    static const AllocGuardMode mode = [] {
+        const char *guard = std::getenv("FCHIGGS_ALLOC_GUARD");
+        if (!guard) { return AllocGuardMode::Off; }
+        if (std::strcmp(guard, "abort") == 0) { return AllocGuardMode::Abort; }
+        return AllocGuardMode::Report;
+    }();
+    return mode;
+}
+
+AllocGuard::AllocGuard(const char *what, const AllocGuardMode &mode)
+    : prev_what_{gstate.what},
+      prev_abort_{gstate.abort},
+      start_{gstate.count},
+      mode_{mode} {
+    GuardState &st = gstate;
+    ++st.depth;
+    st.what = what;
+    st.abort = mode == AllocGuardMode::Abort;
+}
+
+AllocGuard::~AllocGuard() {
+    GuardState &st = gstate;
+    const std::uint64_t n = st.count - start_;
+    const char *what = st.what;
+    --st.depth;
+    st.what = prev_what_;
+    st.abort = prev_abort_;
+    if (mode_ == AllocGuardMode::Report && n > 0) {
+        std::cerr << "fchiggs: " << n << " heap allocations in " << what
+                  << '\n';
+    }
+}
+
+std::uint64_t AllocGuard::count() const { return gstate.count - start_; }
+}  // namespace fchiggs
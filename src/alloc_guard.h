@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_ALLOC_GUARD_H_
+#define FCHIGGS_SRC_ALLOC_GUARD_H_
+
+#include <cstdint>
+
+namespace fchiggs {
+/**
+ *  What to do about a heap allocation inside a guarded block. The drivers
+ *  take it from the environment variable FCHIGGS_ALLOC_GUARD (`report' or
+ *  `abort'), and nothing is done by default.
+ */
+enum class AllocGuardMode { Off, Report, Abort };
+
+AllocGuardMode allocGuardMode();
+
+/**
+ *  Counts the heap allocations of the calling thread while it lives. The
+ *  allocations are seen only in the programs linked with alloc_new.o,
+ *  whose global operator new calls noteAllocation; elsewhere the guards
+ *  count nothing and cost a few stores. The event loops of the integrators
+ *  are guarded, since an allocation there costs a lock in the allocator on
+ *  every event and stops the threads from scaling.
+ *
+ *  With Report, the number of allocations is written to stderr at the end
+ *  of the block if it is not zero. With Abort, the first allocation aborts
+ *  the program, so that a debugger shows where it was made. The guards
+ *  nest, and the innermost one is blamed.
+ */
+class AllocGuard {
+private:
+    const char *prev_what_;
+    bool prev_abort_;
+    std::uint64_t start_;
+    AllocGuardMode mode_;
+
+public:
+    AllocGuard() = delete;
+    /** what names the block in the messages. */
+    explicit AllocGuard(const char *what)
+        : AllocGuard(what, allocGuardMode()) {}
+    AllocGuard(const char *what, const AllocGuardMode &mode);
+    AllocGuard(const AllocGuard &) = delete;
+    AllocGuard &operator=(const AllocGuard &) = delete;
+    ~AllocGuard();
+
+    /** the allocations in the block so far. */
+    std::uint64_t count() const;
+};
+
+/**
+ *  Counts an allocation in the innermost guard of the calling thread, or
+ *  aborts with AllocGuardMode::Abort. It does nothing without a guard and
+ *  never allocates.
+ */
+void noteAllocation();
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_ALLOC_GUARD_H_
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+/*
+ *  The replacement of the global operator new that reports each allocation
+ *  to AllocGuard. It is not in the library, so that a host program keeps
+ *  its own allocator. The Makefile links it into check_regression, and
+ *  into all the executables with `make ALLOC_GUARD=1'.
+ */
+
+#include <cstdlib>
+#include <new>
+#include "alloc_guard.h"
+
+namespace {
+void *allocate(std::size_t n) {
+    fchiggs::noteAllocation();
+    void *p = std::malloc(n ? n : 1);
+    if (!p) { throw std::bad_alloc(); }
+    return p;
+}
+}  // namespace
+
+void *operator new(std::size_t n) { return allocate(n); }
+
+void *operator new[](std::size_t n) { return allocate(n); }
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(n);
+    } catch (const std::bad_alloc &) { return nullptr; }
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(n);
+    } catch (const std::bad_alloc &) { return nullptr; }
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
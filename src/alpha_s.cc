@@ -0,0 +1,129 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "alpha_s.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "constants.h"
+
+namespace fchiggs {
+constexpr double RunningCoupling::QMIN;
+constexpr double RunningCoupling::QMAX;
+constexpr unsigned int RunningCoupling::NPERDECADE;
+
+namespace {
+/** the largest Runge-Kutta step in log(Q^2). */
+constexpr double HMAX = 0.005;
+
+double evolve(double alpha, const double t0, const double t1, const int nf) {
+    const auto nstep =
+        static_cast<unsigned int>(std::ceil(std::fabs(t1 - t0) / HMAX));
+    const double h = (t1 - t0) / nstep;
+    for (unsigned int i = 0; i != nstep; ++i) {
+        const double k1 = RunningCoupling::beta(alpha, nf);
+        const double k2 = RunningCoupling::beta(alpha + 0.5 * h * k1, nf);
+        const double k3 = RunningCoupling::beta(alpha + 0.5 * h * k2, nf);
+        const double k4 = RunningCoupling::beta(alpha + h * k3, nf);
+        alpha += h * (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
+    }
+    return alpha;
+}
+
+/**
+ *  alpha_s of n_f +/- 1 flavors from alpha_s of n_f flavors at the heavy
+ *  quark threshold, Q = m_q, by the three-loop decoupling relation as in
+ *  LHAPDF::AlphaS::_decouple. n_l is the number of light flavors.
+ */
+double decouple(const double alpha, const int nl, const bool up) {
+    const double a = alpha / PI, sign = up ? -1.0 : 1.0;
+    const double c2 = 0.152778, c3 = 0.972057 - 0.0846515 * nl;
+    return alpha * (1.0 + sign * a * a * (c2 + a * c3));
+}
+}  // namespace
+
+double RunningCoupling::beta(const double alpha, const int nf) {
+    // the coefficients of LHAPDF::AlphaS::_beta.
+    const double b0 = 0.875352187 - 0.053051647 * nf;
+    const double b1 = 0.6459225457 - 0.0802126037 * nf;
+    const double b2 = 0.719864327 - 0.140904490 * nf + 0.00303291339 * nf * nf;
+    const double b3 = 1.172686 - 0.2785458 * nf + 0.01624467 * nf * nf +
+                      0.0000601247 * nf * nf * nf;
+    const double a2 = alpha * alpha;
+    return -a2 * (b0 + alpha * (b1 + alpha * (b2 + alpha * b3)));
+}
+
+void RunningCoupling::init(const double alpha_s_mz, const double mz,
+                           const double mb, const double mt) {
+    const double edges[] = {QMIN, mb, mt, QMAX};
+    for (std::size_t i = 0; i != regions_.size(); ++i) {
+        Region &r = regions_[i];
+        r.nf = 4 + i;
+        r.t0 = 2.0 * std::log(edges[i]);
+        const double t1 = 2.0 * std::log(edges[i + 1]);
+        const auto n = static_cast<std::size_t>(std::ceil(
+            NPERDECADE * std::log10(edges[i + 1] / edges[i])));
+        r.dt = (t1 - r.t0) / n;
+        r.alpha.resize(n + 1);
+    }
+
+    // n_f = 5 from m_Z, and then down to Q_min and up to Q_max.
+    Region &r5 = regions_[1];
+    const double tz = 2.0 * std::log(mz);
+    r5.alpha.front() = evolve(alpha_s_mz, tz, r5.t0, r5.nf);
+    for (std::size_t k = 1; k != r5.alpha.size(); ++k) {
+        r5.alpha[k] = evolve(r5.alpha[k - 1], r5.t0 + (k - 1) * r5.dt,
+                             r5.t0 + k * r5.dt, r5.nf);
+    }
+
+    Region &r4 = regions_[0];
+    r4.alpha.back() = decouple(r5.alpha.front(), 4, false);
+    for (std::size_t k = r4.alpha.size() - 1; k != 0; --k) {
+        r4.alpha[k - 1] = evolve(r4.alpha[k], r4.t0 + k * r4.dt,
+                                 r4.t0 + (k - 1) * r4.dt, r4.nf);
+    }
+
+    Region &r6 = regions_[2];
+    r6.alpha.front() = decouple(r5.alpha.back(), 5, true);
+    for (std::size_t k = 1; k != r6.alpha.size(); ++k) {
+        r6.alpha[k] = evolve(r6.alpha[k - 1], r6.t0 + (k - 1) * r6.dt,
+                             r6.t0 + k * r6.dt, r6.nf);
+    }
+}
+
+double RunningCoupling::operator()(const double q) const {
+    const double t = 2.0 * std::log(std::min(std::max(q, QMIN), QMAX));
+    std::size_t i = 0;
+    while (i + 1 != regions_.size() && t > regions_[i + 1].t0) { ++i; }
+    const Region &r = regions_[i];
+
+    const double x = (t - r.t0) / r.dt;
+    const auto k = std::min(static_cast<std::size_t>(std::max(x, 0.0)),
+                            r.alpha.size() - 2);
+    const double s = x - k;
+    const double y0 = r.alpha[k], y1 = r.alpha[k + 1];
+    const double d0 = beta(y0, r.nf) * r.dt, d1 = beta(y1, r.nf) * r.dt;
+    // cubic Hermite interpolation
+    const double s2 = s * s, s3 = s2 * s;
+    return (2 * s3 - 3 * s2 + 1) * y0 + (s3 - 2 * s2 + s) * d0 +
+           (-2 * s3 + 3 * s2) * y1 + (s3 - s2) * d1;
+}
+
+std::vector<double> RunningCoupling::operator()(
+    const std::vector<double> &q) const {
+    std::vector<double> alpha;
+    alpha.reserve(q.size());
+    for (const auto qi : q) { alpha.push_back((*this)(qi)); }
+    return alpha;
+}
+
+const RunningCoupling &alphaS() {
+    static const RunningCoupling alpha_s{ALPHAS, MZ, MB, MT};
+    return alpha_s;
+}
+}  // namespace fchiggs
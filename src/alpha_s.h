@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_ALPHA_S_H_
+#define FCHIGGS_SRC_ALPHA_S_H_
+
+#include <array>
+#include <vector>
+
+namespace fchiggs {
+/**
+ *  The running alpha_s tabulated on a dense grid of log(Q).
+ *
+ *  The renormalization group equation with the four-loop beta function,
+ *  as in LHAPDF::AlphaS_ODE, is solved once from alpha_s(m_Z) with
+ *  Runge-Kutta steps. The number of flavors changes at m_b and m_t, where
+ *  alpha_s is matched by the three-loop decoupling relations as in
+ *  LHAPDF::AlphaS_ODE. Each flavor region has its own grid with the
+ *  thresholds at the edges, and the values between the nodes are given by
+ *  cubic Hermite interpolation with the exact derivatives. The scales
+ *  outside [QMIN, QMAX] are clamped.
+ */
+class RunningCoupling {
+public:
+    static constexpr double QMIN = 1.0;
+    static constexpr double QMAX = 1.0e5;
+    /** the number of nodes per decade of Q. */
+    static constexpr unsigned int NPERDECADE = 200;
+
+private:
+    struct Region {
+        int nf;
+        double t0, dt;  // t = log(Q^2)
+        std::vector<double> alpha;
+    };
+    std::array<Region, 3> regions_;
+
+public:
+    RunningCoupling() = delete;
+    RunningCoupling(const double alpha_s_mz, const double mz, const double mb,
+                    const double mt) {
+        init(alpha_s_mz, mz, mb, mt);
+    }
+
+    double operator()(const double q) const;
+
+    /** alpha_s at each of the scales. */
+    std::vector<double> operator()(const std::vector<double> &q) const;
+
+    /** d alpha_s / d log(Q^2) */
+    static double beta(const double alpha, const int nf);
+
+private:
+    void init(const double alpha_s_mz, const double mz, const double mb,
+              const double mt);
+};
+
+/** alpha_s with the parameters in constants.h. */
+const RunningCoupling &alphaS();
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_ALPHA_S_H_
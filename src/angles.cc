@@ -9,24 +9,35 @@
 #include "angles.h"
 #include <cmath>
 #include "constants.h"
+#include "dual.h"
 
 namespace fchiggs {
-double mpi_half_pi_half(double alpha) {
+template <typename T>
+T mpi_half_pi_half(T alpha) {
     while (alpha > PIHALF) { alpha -= PI; }
     while (alpha < -PIHALF) { alpha += PI; }
     return alpha;
 }
 
-void Angles::initBetas() {
-    double beta = std::atan(tan_beta_);
-    cos_beta_ = std::cos(beta);
+template <typename T>
+void BasicAngles<T>::initBetas() {
+    using std::acos;
+    using std::atan;
+    using std::cos;
+    using std::sin;
+
+    T beta = atan(tan_beta_);
+    cos_beta_ = cos(beta);
     sin_beta_ = cos_beta_ * tan_beta_;
 
-    double alpha = beta + acos(cos_alpha_beta_);
+    T alpha = beta + acos(cos_alpha_beta_);
     alpha = mpi_half_pi_half(alpha);  // -pi/2 <= alpha <= pi/2
-    sin_alpha_ = std::sin(alpha);
-    cos_alpha_ = std::cos(alpha);
+    sin_alpha_ = sin(alpha);
+    cos_alpha_ = cos(alpha);
 
-    sin_alpha_beta_ = std::sin(alpha - beta);
+    sin_alpha_beta_ = sin(alpha - beta);
 }
+
+template class BasicAngles<double>;
+template class BasicAngles<Grad>;
 }  // namespace fchiggs
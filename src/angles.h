@@ -12,31 +12,38 @@
 #include <cmath>
 
 namespace fchiggs {
-class Angles {
+/**
+ *  The angles of the Higgs doublets. The scalar type T is double, or Grad
+ *  for the derivatives with respect to tan(beta) and cos(alpha-beta).
+ */
+template <typename T>
+class BasicAngles {
 private:
-    double sin_alpha_, cos_alpha_;
-    double sin_beta_, cos_beta_, tan_beta_;
-    double sin_alpha_beta_, cos_alpha_beta_;
+    T sin_alpha_, cos_alpha_;
+    T sin_beta_, cos_beta_, tan_beta_;
+    T sin_alpha_beta_, cos_alpha_beta_;
 
 public:
-    Angles() = delete;
-    Angles(const double tan_beta, const double cos_alpha_beta)
+    BasicAngles() = delete;
+    BasicAngles(const T &tan_beta, const T &cos_alpha_beta)
         : tan_beta_(tan_beta), cos_alpha_beta_(cos_alpha_beta) {
         initBetas();
     }
 
-    double sin_alpha() const { return sin_alpha_; }
-    double cos_alpha() const { return cos_alpha_; }
-    double sin_beta() const { return sin_beta_; }
-    double cos_beta() const { return cos_beta_; }
-    double tan_beta() const { return tan_beta_; }
-    double sin_alpha_beta() const { return sin_alpha_beta_; }
-    double cos_alpha_beta() const { return cos_alpha_beta_; }
+    T sin_alpha() const { return sin_alpha_; }
+    T cos_alpha() const { return cos_alpha_; }
+    T sin_beta() const { return sin_beta_; }
+    T cos_beta() const { return cos_beta_; }
+    T tan_beta() const { return tan_beta_; }
+    T sin_alpha_beta() const { return sin_alpha_beta_; }
+    T cos_alpha_beta() const { return cos_alpha_beta_; }
 
 private:
     void initBetas();
 };
 
+using Angles = BasicAngles<double>;
+
 class HiggsMixing {
 private:
     double c1_, c2_, c3_;
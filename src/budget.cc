@@ -0,0 +1,175 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "budget.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "alloc_guard.h"
+#include "utils.h"
+#include "xsec.h"
+
+namespace fchiggs {
+namespace {
+double elapsed(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+}  // namespace
+
+Objective budgetObjective() {
+    const char *obj = std::getenv("FCHIGGS_OBJECTIVE");
+    if (obj && std::string{obj} == "sum") { return Objective::SumRelError; }
+    return Objective::MaxRelError;
+}
+
+BudgetScheduler::BudgetScheduler(const std::vector<Production> &prods,
+                                 const Objective &objective,
+                                 const std::vector<double> &weights)
+    : objective_{objective}, spent_{0} {
+    for (std::size_t i = 0; i != prods.size(); ++i) {
+        const double w = i < weights.size() ? weights[i] : 1.0;
+        items_.push_back({prods[i], w, 0, 0, 0, 0});
+    }
+}
+
+void BudgetScheduler::run(const double budget, const unsigned int nrounds,
+                          const unsigned int nthreads) {
+    unsigned int nth = std::max(nthreads, 1u);
+    for (const auto &item : items_) {
+        if (!item.prod.pdf()->threadSafe()) { nth = 1; }
+    }
+
+    // the cost of the pilot from a few events of each point, not kept.
+    auto start = std::chrono::steady_clock::now();
+    for (auto &item : items_) {
+        for (unsigned int j = 0; j != NPROBE; ++j) { item.prod.weight(); }
+    }
+    const double probe = elapsed(start);
+    spent_ += probe;
+    const double pilot = probe / NPROBE * NPILOT;
+    const double scale =
+        PILOTSHARE * budget < pilot ? PILOTSHARE * budget / pilot : 1.0;
+    const auto npilot = std::max(
+        NPILOTMIN, static_cast<unsigned int>(scale * NPILOT));
+
+    // the warm-up of the channels as in integrate, then the pilot.
+    const auto nwarmup = static_cast<unsigned int>(WARMUP * npilot);
+    start = std::chrono::steady_clock::now();
+    for (auto &item : items_) {
+        item.prod.adaptChannels(nwarmup / NWARMUPITER, NWARMUPITER);
+        if (useControlVariates()) { item.prod.addControlVariate(); }
+    }
+    spent_ += elapsed(start);
+    runRound(std::vector<std::uint64_t>(items_.size(), npilot - nwarmup),
+             nth);
+
+    for (unsigned int round = 0; round != nrounds && spent_ < budget;
+         ++round) {
+        // the same share of the remaining budget for each round.
+        const double share = (budget - spent_) / (nrounds - round);
+        const auto nevents = allocate(share);
+        if (std::all_of(nevents.begin(), nevents.end(),
+                        [](const std::uint64_t n) { return n == 0; })) {
+            break;
+        }
+        runRound(nevents, nth);
+    }
+}
+
+std::pair<double, double> BudgetScheduler::result(const std::size_t i) const {
+    const auto &item = items_[i];
+    if (item.n == 0) { return {0, 0}; }
+    return sigma(item.sum_w, item.sum_w_sq, item.n);
+}
+
+void BudgetScheduler::runRound(const std::vector<std::uint64_t> &nevents,
+                               const unsigned int nthreads) {
+    std::atomic<std::size_t> next{0};
+    std::vector<double> seconds(nthreads, 0);
+    const auto worker = [&](const unsigned int ithread) {
+        for (std::size_t i = next++; i < items_.size(); i = next++) {
+            auto &item = items_[i];
+            const auto start = std::chrono::steady_clock::now();
+            double sum_w = 0, sum_w_sq = 0;
+            {
+                const AllocGuard guard{"BudgetScheduler"};
+                for (std::uint64_t j = 0; j != nevents[i]; ++j) {
+                    const double w = item.prod.weight();
+                    sum_w += w;
+                    sum_w_sq += w * w;
+                }
+            }
+            const double dt = elapsed(start);
+            // each point is run by a single thread at a time.
+            item.sum_w += sum_w;
+            item.sum_w_sq += sum_w_sq;
+            item.n += nevents[i];
+            item.seconds += dt;
+            seconds[ithread] += dt;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < nthreads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &t : threads) { t.join(); }
+    for (const auto dt : seconds) { spent_ += dt; }
+}
+
+std::vector<std::uint64_t> BudgetScheduler::allocate(
+    const double seconds) const {
+    // the target profile p_i and the cost c_i of each point.
+    std::vector<double> p(items_.size(), 0), c(items_.size(), 0);
+    for (std::size_t i = 0; i != items_.size(); ++i) {
+        const auto &item = items_[i];
+        if (item.n == 0 || item.sum_w <= 0) { continue; }
+        const double mean = item.sum_w / item.n;
+        const double var = std::max(item.sum_w_sq / item.n - mean * mean, 0.0);
+        c[i] = std::max(item.seconds / item.n, MINCOST);
+        const double rel = std::sqrt(var) / mean;  // of a single weight
+        if (objective_ == Objective::MaxRelError) {
+            p[i] = rel * rel;
+        } else {
+            p[i] = std::cbrt(std::pow(item.weight * rel / c[i], 2));
+        }
+    }
+
+    // the cost of raising the points to k p_i.
+    const auto cost = [&](const double k) {
+        double t = 0;
+        for (std::size_t i = 0; i != items_.size(); ++i) {
+            t += c[i] * std::max(k * p[i] - items_[i].n, 0.0);
+        }
+        return t;
+    };
+    double hi = 1;
+    while (cost(hi) < seconds && hi < 1e300) { hi *= 2; }
+    double lo = 0;
+    for (int iter = 0; iter != 100; ++iter) {
+        const double mid = 0.5 * (lo + hi);
+        (cost(mid) < seconds ? lo : hi) = mid;
+    }
+
+    std::vector<std::uint64_t> nevents(items_.size(), 0);
+    for (std::size_t i = 0; i != items_.size(); ++i) {
+        nevents[i] = static_cast<std::uint64_t>(
+            std::max(lo * p[i] - items_[i].n, 0.0));
+    }
+    return nevents;
+}
+}  // namespace fchiggs
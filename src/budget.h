@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_BUDGET_H_
+#define FCHIGGS_SRC_BUDGET_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "xsec.h"
+
+namespace fchiggs {
+/**
+ *  The objective of the allocation of the events.
+ *
+ *  MaxRelError: the largest relative error of the cross sections.
+ *  SumRelError: the weighted sum of the relative errors.
+ */
+enum class Objective { MaxRelError, SumRelError };
+
+/**
+ *  The drivers take it from the environment variable FCHIGGS_OBJECTIVE
+ *  (`max' or `sum'), and `max' is the default.
+ */
+Objective budgetObjective();
+
+/** the events of each point in the first round. */
+constexpr unsigned int NPILOT = 20000;
+/** the fewest events of each point in the first round. */
+constexpr unsigned int NPILOTMIN = 2000;
+/** the largest share of the budget taken by the first round. */
+constexpr double PILOTSHARE = 0.25;
+/** the events of each point that give its cost before the first round. */
+constexpr unsigned int NPROBE = 100;
+/** the least CPU time of an event in seconds. */
+constexpr double MINCOST = 1.0e-9;
+
+/**
+ *  Integrates many productions with a common budget of CPU time.
+ *
+ *  All the points are run in rounds by plain Monte Carlo. The first round
+ *  tunes the \hat{s} channels and takes NPILOT events per point, or fewer,
+ *  down to NPILOTMIN, if it would take more than PILOTSHARE of the budget
+ *  at the cost of NPROBE events of each point. After
+ *  each round, the standard deviation of the weights and the time per
+ *  event of each point give the allocation of the next round. With the
+ *  events so far as lower bounds, the optimum of either objective is
+ *  n_i = max(n_i, k p_i) with
+ *
+ *    MaxRelError: p_i = (s_i / sigma_i)^2,
+ *    SumRelError: p_i = (w_i s_i / (sigma_i c_i))^{2/3},
+ *
+ *  where s_i is the standard deviation of a weight and c_i the cost of an
+ *  event, at least MINCOST. k is chosen so that the round takes its share
+ *  of the remaining budget. The points of zero cross section get no more
+ *  events.
+ */
+class BudgetScheduler {
+private:
+    struct Item {
+        Production prod;
+        double weight;
+        double sum_w, sum_w_sq;
+        std::uint64_t n;
+        double seconds;  // spent on the events, excluding the warm-up
+    };
+
+    std::vector<Item> items_;
+    Objective objective_;
+    double spent_;
+
+public:
+    BudgetScheduler() = delete;
+    /** the weights of the points are used only for SumRelError. */
+    BudgetScheduler(const std::vector<Production> &prods,
+                    const Objective &objective,
+                    const std::vector<double> &weights = {});
+
+    /**
+     *  Runs the rounds until the budget in CPU seconds is used up or
+     *  nrounds rounds are made after the first, with nthreads threads if
+     *  the PDFs of all the points are thread-safe.
+     */
+    void run(const double budget, const unsigned int nrounds,
+             const unsigned int nthreads);
+
+    std::size_t size() const { return items_.size(); }
+
+    /** the cross section and its error in pb of the i-th point. */
+    std::pair<double, double> result(const std::size_t i) const;
+
+    std::uint64_t events(const std::size_t i) const { return items_[i].n; }
+
+    /** the CPU time used so far in seconds. */
+    double spent() const { return spent_; }
+
+private:
+    /** runs the given number of events of each point. */
+    void runRound(const std::vector<std::uint64_t> &nevents,
+                  const unsigned int nthreads);
+
+    /** the events of each point in a round of the given CPU time. */
+    std::vector<std::uint64_t> allocate(const double seconds) const;
+};
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_BUDGET_H_
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "alpha_s.h"
+#include "angles.h"
+#include "constants.h"
+#include "couplings.h"
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "pdf.h"
+#include "surrogate.h"
+#include "user_interface.h"
+#include "xsec.h"
+
+using std::to_string;
+
+constexpr char appname[] = "build_surrogate";
+
+constexpr double ECM = 14000.0;
+constexpr double SBEAM = ECM * ECM;
+constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
+constexpr unsigned int N = 800000;
+constexpr unsigned int NH = 8500000;  // for p p --> H
+constexpr double MHSM = 125.0;
+constexpr double MZP = 400.0;
+constexpr double GZPX = 0.01;
+constexpr double MU = 200.0;
+constexpr double VS = 1000.0;
+
+using Quantity = std::function<std::pair<double, double>(
+    const double, const double, const double)>;
+
+double branchingRatio(const std::vector<std::pair<std::string, double>> &brs,
+                      const std::string &mode) {
+    for (const auto &br : brs) {
+        if (br.first == mode) { return br.second; }
+    }
+    std::cerr << appname << ": unknown decay mode `" << mode << "'\n";
+    std::exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 12) {
+        std::cerr
+            << "Usage: " << appname
+            << " <quantity> <m_H min> <m_H max> <tan(beta) min>"
+               " <tan(beta) max> <cos(alpha-beta) min> <cos(alpha-beta) max>"
+               " <n(m_H)> <n(tan(beta))> <n(cos(alpha-beta))> <output>\n"
+            << "  quantity: pph_neutral, pphb_neutral, ppht_charged,"
+               " pphb_charged,\n"
+            << "            br_neutral:<mode> or br_charged:<mode>\n";
+        return 1;
+    }
+
+    const std::string quantity{argv[1]};
+    const std::array<double, 3> lo{
+        {std::atof(argv[2]), std::atof(argv[4]), std::atof(argv[6])}};
+    const std::array<double, 3> hi{
+        {std::atof(argv[3]), std::atof(argv[5]), std::atof(argv[7])}};
+    const std::array<std::uint32_t, 3> order{
+        {static_cast<std::uint32_t>(std::atoi(argv[8])),
+         static_cast<std::uint32_t>(std::atoi(argv[9])),
+         static_cast<std::uint32_t>(std::atoi(argv[10]))}};
+    for (const auto n : order) {
+        if (n == 0 || n > fchiggs::Surrogate::MAXORDER) {
+            std::cerr << appname << ": the number of nodes must be in [1, "
+                      << fchiggs::Surrogate::MAXORDER << "]\n";
+            return 1;
+        }
+    }
+
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+
+    // the cross sections are fitted in the log space, and tan(beta) is
+    // sampled logarithmically when the range is positive.
+    bool is_xsec = true;
+    Quantity eval;
+    const auto production = [&pdf](const fchiggs::Process proc,
+                                   const unsigned int n) {
+        return [&pdf, proc, n](const double mh, const double tan_beta,
+                               const double cos_alpha_beta) {
+            const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+            const fchiggs::Production prod{proc, pdf, SBEAM, mh, ang};
+            return fchiggs::xsec(prod, n);
+        };
+    };
+    if (quantity == "pph_neutral") {
+        eval = production(fchiggs::Process::H, NH);
+    } else if (quantity == "pphb_neutral") {
+        eval = production(fchiggs::Process::Hb, N);
+    } else if (quantity == "ppht_charged") {
+        eval = production(fchiggs::Process::HtCharged, N);
+    } else if (quantity == "pphb_charged") {
+        eval = production(fchiggs::Process::HbCharged, N);
+    } else if (quantity.compare(0, 11, "br_neutral:") == 0) {
+        is_xsec = false;
+        const std::string mode = quantity.substr(11);
+        eval = [mode](const double mh, const double tan_beta,
+                      const double cos_alpha_beta) {
+            const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+            const fchiggs::Hup cup{ang, Y33U};
+            const fchiggs::Hdown cdown{ang};
+            fchiggs::HQuartic lambda_h{MHSM, mh, fchiggs::Mu(MU),
+                                       fchiggs::Vs(VS), ang};
+            const fchiggs::HiggsDecayWidth hdecay{
+                mh,
+                MHSM,
+                MZP,
+                fchiggs::alphaS()(mh),
+                fchiggs::GZPX(GZPX),
+                fchiggs::GH3(lambda_h.trilinear()),
+                cup,
+                cdown,
+                ang};
+            return std::make_pair(
+                branchingRatio(hdecay.branchingRatios(), mode), 0.0);
+        };
+    } else if (quantity.compare(0, 11, "br_charged:") == 0) {
+        is_xsec = false;
+        const std::string mode = quantity.substr(11);
+        eval = [mode](const double mh, const double tan_beta,
+                      const double cos_alpha_beta) {
+            const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+            const fchiggs::Hup cup{ang, Y33U};
+            const fchiggs::Hdown cdown{ang};
+            const fchiggs::ChargedHiggsDecayWidth hdecay{
+                mh, MHSM, cup, fchiggs::VHd{cdown}, ang};
+            return std::make_pair(
+                branchingRatio(hdecay.branchingRatios(), mode), 0.0);
+        };
+    } else {
+        std::cerr << appname << ": unknown quantity `" << quantity << "'\n";
+        return 1;
+    }
+
+    const std::array<std::uint32_t, 3> logscale{
+        {0, lo[1] > 0 ? 1u : 0u, 0}};
+    fchiggs::Surrogate surrogate{is_xsec, order, logscale, lo, hi};
+
+    const std::size_t nnodes = order[0] * order[1] * order[2];
+    message(appname, "fitting " + quantity + " on " + to_string(nnodes) +
+                         " nodes ...");
+    std::vector<double> values, errors;
+    for (std::uint32_t i = 0; i != order[0]; ++i) {
+        const double mh = surrogate.node(0, i);
+        for (std::uint32_t j = 0; j != order[1]; ++j) {
+            const double tan_beta = surrogate.node(1, j);
+            for (std::uint32_t k = 0; k != order[2]; ++k) {
+                const double cos_alpha_beta = surrogate.node(2, k);
+                const auto result = eval(mh, tan_beta, cos_alpha_beta);
+                values.push_back(result.first);
+                errors.push_back(result.second);
+            }
+        }
+        message(appname, "m_H = " + to_string(mh) + " GeV done.");
+    }
+    surrogate.fit(values, errors);
+    message(appname, "... done.");
+    if (is_xsec && !surrogate.logTransform()) {
+        message(appname, "the cross section vanishes at some nodes, "
+                         "so it is fitted without the log.");
+    }
+    message(appname, std::string("estimated ") +
+                         (surrogate.logTransform() ? "relative " : "") +
+                         "error = " +
+                         to_string(surrogate.truncationError()) +
+                         " (truncation) + " +
+                         to_string(surrogate.statisticalError()) +
+                         " (statistical)");
+
+    surrogate.save(argv[11]);
+    message(appname,
+            "the output has been saved to `" + std::string(argv[11]) + "'.");
+}
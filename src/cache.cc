@@ -0,0 +1,269 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "cache.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "constants.h"
+#include "temp_file.h"
+#include "utils.h"
+#include "xsec.h"
+
+namespace fchiggs {
+namespace {
+constexpr char MAGIC[] = "fchiggs-cache";
+
+std::string processName(const Process &proc) {
+    if (proc == Process::H) { return "pph_neutral"; }
+    if (proc == Process::Hb) { return "pphb_neutral"; }
+    if (proc == Process::HtCharged) { return "ppht_charged"; }
+    return "pphb_charged";
+}
+
+/** the 64-bit FNV-1a hash. */
+std::uint64_t fnv1a(const std::string &str) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char c : str) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+std::string toString(const CacheKey &key, const CacheEntry &entry) {
+    std::ostringstream os;
+    os << std::setprecision(17);
+    os << MAGIC << ' ' << CACHEVERSION << '\n' << "key " << key.str() << '\n';
+    if (entry.n > 0) {
+        os << "sigma " << entry.sigma << '\n'
+           << "error " << entry.error << '\n'
+           << "n " << entry.n << '\n'
+           << "seeds";
+        for (const auto seed : entry.seeds) { os << ' ' << seed; }
+        os << '\n';
+    }
+    for (const auto &br : entry.br) {
+        os << "br " << br.first << ' ' << br.second << '\n';
+    }
+    return os.str();
+}
+
+bool contains(const std::vector<std::uint64_t> &seeds,
+              const std::vector<std::uint64_t> &others) {
+    for (const auto seed : others) {
+        if (std::find(seeds.begin(), seeds.end(), seed) != seeds.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** the seed of a run of the key after nstored events in the cache. */
+std::uint64_t runSeed(const CacheKey &key, const std::uint64_t nstored) {
+    return splitmix64((randomSeed() ^ fnv1a(key.str())) +
+                      (nstored + 1) * 0x9e3779b97f4a7c15ULL);
+}
+
+/** combines the runs in proportion to their numbers of events. */
+CacheEntry merge(const CacheEntry &stored, const CacheEntry &run) {
+    CacheEntry merged{stored};
+    if (merged.br.empty()) { merged.br = run.br; }
+    if (run.n == 0) { return merged; }
+
+    if (stored.n == 0 || contains(stored.seeds, run.seeds)) {
+        // the same events must not be counted twice.
+        if (run.n > stored.n) {
+            merged.sigma = run.sigma;
+            merged.error = run.error;
+            merged.n = run.n;
+            merged.seeds = run.seeds;
+        }
+        return merged;
+    }
+
+    const double n1 = stored.n, n2 = run.n, n = n1 + n2;
+    merged.sigma = (n1 * stored.sigma + n2 * run.sigma) / n;
+    merged.error = std::hypot(n1 * stored.error, n2 * run.error) / n;
+    merged.n = stored.n + run.n;
+    merged.seeds.insert(merged.seeds.end(), run.seeds.begin(),
+                        run.seeds.end());
+    return merged;
+}
+}  // namespace
+
+CacheKey::CacheKey(const std::string &kind) : str_{kind} {
+    // the constants that enter the cross sections and the widths.
+    add("version", CACHEVERSION);
+    add("MT", MT).add("MB", MB).add("MC", MC).add("MMU", MMU);
+    add("MTAU", MTAU).add("MW", MW).add("MZ", MZ).add("GF", GF);
+    add("ALPHAS", ALPHAS).add("ALPHA", ALPHA).add("KGG", KGG);
+    add("VUD", VUD).add("VUS", VUS).add("VUB", VUB);
+    add("VCD", VCD).add("VCS", VCS).add("VCB", VCB);
+    add("VTD", VTD).add("VTS", VTS).add("VTB", VTB);
+}
+
+CacheKey &CacheKey::add(const std::string &name, const double v) {
+    std::ostringstream os;
+    os << std::setprecision(17) << v;
+    return add(name, os.str());
+}
+
+CacheKey &CacheKey::add(const std::string &name, const std::string &v) {
+    str_ += "; " + name + " = " + v;
+    return *this;
+}
+
+CacheKey productionKey(const Production &prod, const Method &method) {
+    CacheKey key{processName(prod.process())};
+    key.add("m_H", prod.mh())
+        .add("tan(beta)", prod.angles().tan_beta())
+        .add("cos(alpha-beta)", prod.angles().cos_alpha_beta())
+        .add("sqrt(s)", std::sqrt(prod.s()))
+        .add("PDF", prod.pdf()->setName())
+        .add("member", prod.pdf()->member())
+        .add("PDF backend", prod.pdf()->backend())
+        .add("mu", prod.mu())
+        .add("alpha_s", prod.alpha_s())
+        // the matrix elements are in double. The field keeps the keys of
+        // the caches made while they could also be in float.
+        .add("precision", "double");
+    // without the cuts, the keys of the earlier caches remain valid.
+    if (prod.cuts().active()) { key.add("cuts", prod.cuts().str()); }
+    // likewise for the default method without the control variate.
+    if (method == Method::QMC) {
+        key.add("method", "qmc");
+    } else if (method == Method::Stratified) {
+        key.add("method", "stratified");
+    }
+    if (useControlVariates() && prod.controlVariateAvailable()) {
+        key.add("control variate", "narrow width");
+    }
+    return key;
+}
+
+CacheEntry::CacheEntry()
+    : sigma{std::numeric_limits<double>::quiet_NaN()},
+      error{std::numeric_limits<double>::quiet_NaN()},
+      n{0} {}
+
+ResultCache::ResultCache(const std::string &dir) : dir_{dir} {
+    ::mkdir(dir_.c_str(), 0755);
+    // those of the jobs killed while saving an entry.
+    sweepTemporaries(dir_, "");
+}
+
+std::string ResultCache::path(const CacheKey &key) const {
+    char hash[17];
+    std::snprintf(hash, sizeof hash, "%016llx",
+                  static_cast<unsigned long long>(fnv1a(key.str())));
+    return dir_ + '/' + hash;
+}
+
+bool ResultCache::find(const CacheKey &key, CacheEntry *entry) const {
+    std::ifstream fin{path(key)};
+    std::string line;
+    if (!std::getline(fin, line) ||
+        line != MAGIC + (' ' + std::to_string(CACHEVERSION))) {
+        return false;
+    }
+    // a different key of the same hash is a miss.
+    if (!std::getline(fin, line) || line != "key " + key.str()) {
+        return false;
+    }
+
+    CacheEntry found;
+    while (std::getline(fin, line)) {
+        std::istringstream is{line};
+        std::string field, value;
+        is >> field;
+        if (field == "sigma" && is >> value) {
+            found.sigma = std::strtod(value.c_str(), nullptr);
+        } else if (field == "error" && is >> value) {
+            found.error = std::strtod(value.c_str(), nullptr);
+        } else if (field == "n") {
+            is >> found.n;
+        } else if (field == "seeds") {
+            std::uint64_t seed;
+            while (is >> seed) { found.seeds.push_back(seed); }
+        } else if (field == "br" && is >> field >> value) {
+            found.br.emplace_back(field, std::strtod(value.c_str(), nullptr));
+        }
+    }
+    *entry = found;
+    return true;
+}
+
+bool ResultCache::add(const CacheKey &key, const CacheEntry &run,
+                      CacheEntry *merged) const {
+    *merged = run;
+    const std::string fname = path(key);
+    const int lock = ::open((fname + ".lock").c_str(),
+                            O_RDWR | O_CREAT | O_NOFOLLOW, 0644);
+    if (lock < 0) { return false; }
+    // the stored entry must not change between reading and replacing it.
+    bool ok = ::flock(lock, LOCK_EX) == 0;
+    if (ok) {
+        CacheEntry stored;
+        if (find(key, &stored)) { *merged = merge(stored, run); }
+        const std::string buf = toString(key, *merged);
+        ok = writeFile(fname, buf.data(), buf.size(), Placement::Replace);
+    }
+    ::close(lock);  // releases the lock
+    return ok;
+}
+
+std::unique_ptr<ResultCache> resultCache() {
+    const char *dir = std::getenv("FCHIGGS_CACHE");
+    if (!dir || !*dir) { return nullptr; }
+    return std::unique_ptr<ResultCache>{new ResultCache{dir}};
+}
+
+std::pair<double, double> integrate(const ResultCache *cache,
+                                    const Production &prod,
+                                    const unsigned int n, const Method &method,
+                                    std::ostream *diag, std::uint64_t *nevent,
+                                    std::uint64_t *seed) {
+    const CacheKey key = productionKey(prod, method);
+    CacheEntry stored;
+    if (cache && cache->find(key, &stored) && stored.n >= n) {
+        if (nevent) { *nevent = stored.n; }
+        if (seed) { *seed = stored.seeds.size() == 1 ? stored.seeds[0] : 0; }
+        return {stored.sigma, stored.error};
+    }
+
+    // top up the stored result with the missing events.
+    const auto ntopup = std::max(static_cast<unsigned int>(n - stored.n),
+                                 static_cast<unsigned int>(MINTOPUP * n));
+    CacheEntry run;
+    run.n = cache ? ntopup : n;
+    run.seeds = {runSeed(key, stored.n)};
+    setRandomSeed(run.seeds[0]);
+    std::tie(run.sigma, run.error) = integrate(prod, run.n, method, diag);
+    CacheEntry merged{run};
+    if (cache) { cache->add(key, run, &merged); }
+    if (nevent) { *nevent = merged.n; }
+    if (seed) { *seed = merged.seeds.size() == 1 ? merged.seeds[0] : 0; }
+    return {merged.sigma, merged.error};
+}
+}  // namespace fchiggs
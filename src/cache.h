@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_CACHE_H_
+#define FCHIGGS_SRC_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "xsec.h"
+
+namespace fchiggs {
+/**
+ *  The version of the cached results. It must be increased whenever the
+ *  matrix elements or the widths change, so that old entries are not used.
+ */
+constexpr int CACHEVERSION = 1;
+
+/**
+ *  The canonical description of a result: its kind and all the inputs it
+ *  depends on, including the physical constants. Doubles are written with
+ *  17 digits, so that different inputs never share a key.
+ */
+class CacheKey {
+private:
+    std::string str_;
+
+public:
+    CacheKey() = delete;
+    explicit CacheKey(const std::string &kind);
+
+    CacheKey &add(const std::string &name, const double v);
+    CacheKey &add(const std::string &name, const std::string &v);
+
+    const std::string &str() const { return str_; }
+};
+
+/**
+ *  The key of the cross section of the production by the method: the
+ *  process, the parameter point, sqrt(s), the PDF set, member and backend,
+ *  the scale, alpha_s, the precision of the matrix elements and, if they
+ *  are not the defaults, the method and the control variate. The runs of
+ *  different methods or with and without the control variate have very
+ *  different errors per event, so they are not merged.
+ */
+CacheKey productionKey(const Production &prod,
+                       const Method &method = Method::MC);
+
+/**
+ *  A cached result. The cross section is NaN and n is zero for the BRs
+ *  alone. The seeds of the runs merged into it are kept, so that the same
+ *  events are never counted twice.
+ */
+struct CacheEntry {
+    double sigma, error;
+    std::uint64_t n;
+    std::vector<std::uint64_t> seeds;
+    std::vector<std::pair<std::string, double>> br;
+
+    CacheEntry();
+};
+
+/**
+ *  The results in a directory, one file per key named by the 64-bit
+ *  FNV-1a hash of the key. A file is always replaced by rename(2), so
+ *  readers need no lock, and updates are serialized by flock(2) on a
+ *  lock file next to it. It is safe to share the directory between
+ *  concurrent jobs on a file system with working flock, such as a local
+ *  disk.
+ */
+class ResultCache {
+private:
+    std::string dir_;
+
+public:
+    ResultCache() = delete;
+    /** creates the directory if it does not exist. */
+    explicit ResultCache(const std::string &dir);
+
+    const std::string &directory() const { return dir_; }
+
+    /** the stored entry of the key. false if there is none. */
+    bool find(const CacheKey &key, CacheEntry *entry) const;
+
+    /**
+     *  Merges the run into the stored entry and saves it. The cross
+     *  sections are combined in proportion to the numbers of events, as
+     *  independent runs, unless the seed of the run is already in the
+     *  entry, in which case the one with more events is kept. The result
+     *  is the merged entry, or the run itself if it cannot be saved.
+     */
+    bool add(const CacheKey &key, const CacheEntry &run,
+             CacheEntry *merged) const;
+
+private:
+    std::string path(const CacheKey &key) const;
+};
+
+/** the cache in the directory FCHIGGS_CACHE, or null if it is not set. */
+std::unique_ptr<ResultCache> resultCache();
+
+/** the fraction of n below which a top-up run is not made smaller. */
+constexpr double MINTOPUP = 0.1;
+
+/**
+ *  The cross section as in integrate, through the cache if it is not null.
+ *  The stored result is used as it is if it has at least n events, since
+ *  its error is then at most that of a new run. Otherwise the missing
+ *  events, but at least MINTOPUP n, are integrated and merged into it.
+ *
+ *  Each run restarts the generator of the calling thread from a seed of
+ *  its own, mixed from randomSeed(), the key and the events stored before
+ *  it. With a fixed FCHIGGS_SEED, a top-up thus adds new events, while the
+ *  same run made twice is recognized, and the events of a point do not
+ *  depend on the thread that runs it.
+ *
+ *  The number of events behind the result is set to nevent, and the seed
+ *  of its events to seed, or zero if it merges several runs, if they are
+ *  not null.
+ */
+std::pair<double, double> integrate(const ResultCache *cache,
+                                    const Production &prod,
+                                    const unsigned int n, const Method &method,
+                                    std::ostream *diag = nullptr,
+                                    std::uint64_t *nevent = nullptr,
+                                    std::uint64_t *seed = nullptr);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_CACHE_H_
@@ -0,0 +1,706 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "alloc_guard.h"
+#include "alpha_s.h"
+#include "angles.h"
+#include "cache.h"
+#include "constants.h"
+#include "couplings.h"
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "initial_states.h"
+#include "pdf.h"
+#include "results.h"
+#include "sigma_pphq.h"
+#include "user_interface.h"
+#include "xsec.h"
+
+constexpr char appname[] = "check_regression";
+
+constexpr double ECM = 14000.0;
+constexpr double SBEAM = ECM * ECM;
+constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
+/** the committed reference of the quantities that need no PDF. */
+constexpr char REFERENCE[] = "data/reference.dat";
+constexpr unsigned int N = 200000;
+constexpr double MHSM = 125.0;
+constexpr double MZP = 400.0;
+constexpr double GZPX = 0.01;
+constexpr double MU = 200.0;
+constexpr double VS = 1000.0;
+
+/** the tolerances of the comparisons with the reference. */
+constexpr std::int64_t MAXULP = 16;
+constexpr double RELTOL = 1.0e-10;
+constexpr double MAXPULL = 4.0;
+
+/**
+ *  How a quantity is compared with the reference:
+ *
+ *  Ulp:      the kernels without a PDF, within MAXULP units in the last
+ *            place,
+ *  Relative: the weights at fixed points and the branching ratios, within
+ *            RELTOL,
+ *  Pull:     the integrated cross sections, within MAXPULL combined
+ *            standard deviations.
+ */
+enum class Check { Ulp, Relative, Pull };
+
+struct Quantity {
+    std::string name;
+    Check check;
+    double value, error;
+};
+
+struct Point {
+    double mh, tan_beta, cos_alpha_beta;
+};
+
+/** the benchmark points of (m_H, tan(beta), cos(alpha-beta)). */
+const std::vector<Point> POINTS{{300.0, 1.0, 0.05}, {800.0, 5.0, 0.2}};
+
+/** the fixed points of the unit square of the weights. */
+const std::vector<fchiggs::Uniforms> UNIFORMS{
+    {0.01, 0.5}, {0.3, 0.2}, {0.5, 0.5}, {0.7, 0.9}, {0.95, 0.4}};
+
+const std::vector<std::pair<std::string, fchiggs::Process>> PROCESSES{
+    {"pph_neutral", fchiggs::Process::H},
+    {"pphb_neutral", fchiggs::Process::Hb},
+    {"ppht_charged", fchiggs::Process::HtCharged},
+    {"pphb_charged", fchiggs::Process::HbCharged}};
+
+std::string label(const Point &p) {
+    std::ostringstream os;
+    os << p.mh << '/' << p.tan_beta << '/' << p.cos_alpha_beta;
+    return os.str();
+}
+
+std::string sci(const double x) {
+    std::ostringstream os;
+    os << std::scientific << std::setprecision(3) << x;
+    return os.str();
+}
+
+/** the distance of two doubles of the same sign in units in the last place. */
+std::int64_t ulps(const double a, const double b) {
+    if (a == b) { return 0; }
+    if (std::isnan(a) || std::isnan(b) || std::signbit(a) != std::signbit(b)) {
+        return INT64_MAX;
+    }
+    std::int64_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(double));
+    std::memcpy(&ib, &b, sizeof(double));
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+/** the partonic cross sections and alpha_s, which need no PDF. */
+void kernels(std::vector<Quantity> *qs) {
+    // (m_qin, m_qout) of the b g, u g and b g --> t channels.
+    const std::vector<std::pair<double, double>> masses{
+        {MB, MB}, {0.0, MB}, {MB, MT}};
+    for (const auto &m : masses) {
+        for (const double mh : {300.0, 800.0}) {
+            const double thres = mh + m.second;
+            for (const double r : {1.01, 1.5, 4.0, 30.0}) {
+                const double shat = r * thres * thres;
+                std::ostringstream name;
+                name << "sigma_hat/" << m.first << '/' << m.second << '/' << mh
+                     << '/' << r;
+                const double sig = fchiggs::sigma_hat<double>(
+                    shat, mh, m.first, m.second, 0.1, 0.3, 0.1);
+                qs->push_back({name.str(), Check::Ulp, sig, 0});
+            }
+        }
+    }
+    for (const double q : {5.0, 91.1876, 300.0, 2000.0}) {
+        std::ostringstream name;
+        name << "alpha_s/" << q;
+        qs->push_back({name.str(), Check::Ulp, fchiggs::alphaS()(q), 0});
+    }
+}
+
+/** the weights at fixed points, including the PDFs and the s-hat maps. */
+void weights(std::shared_ptr<fchiggs::PartonDensity> pdf,
+             std::vector<Quantity> *qs) {
+    for (const auto &proc : PROCESSES) {
+        for (const auto &p : POINTS) {
+            const fchiggs::Production prod{
+                proc.second, pdf, SBEAM, p.mh,
+                fchiggs::Angles{p.tan_beta, p.cos_alpha_beta}};
+            for (std::size_t i = 0; i != UNIFORMS.size(); ++i) {
+                qs->push_back({"weight/" + proc.first + '/' + label(p) + '/' +
+                                   std::to_string(i),
+                               Check::Relative, prod.weight(UNIFORMS[i]), 0});
+            }
+        }
+    }
+}
+
+/** the branching ratios of H and H^\pm. */
+void widths(std::vector<Quantity> *qs) {
+    for (const auto &p : POINTS) {
+        const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+        const fchiggs::Hup cup{ang, Y33U};
+        const fchiggs::Hdown cdown{ang};
+        fchiggs::HQuartic lambda_h{MHSM, p.mh, fchiggs::Mu(MU),
+                                   fchiggs::Vs(VS), ang};
+        const fchiggs::HiggsDecayWidth hdecay{
+            p.mh,
+            MHSM,
+            MZP,
+            fchiggs::alphaS()(p.mh),
+            fchiggs::GZPX(GZPX),
+            fchiggs::GH3(lambda_h.trilinear()),
+            cup,
+            cdown,
+            ang};
+        for (const auto &br : hdecay.branchingRatios()) {
+            qs->push_back({"br_neutral/" + label(p) + '/' + br.first,
+                           Check::Relative, br.second, 0});
+        }
+        const fchiggs::ChargedHiggsDecayWidth hdecay_charged{
+            p.mh, MHSM, cup, fchiggs::VHd{cdown}, ang};
+        for (const auto &br : hdecay_charged.branchingRatios()) {
+            qs->push_back({"br_charged/" + label(p) + '/' + br.first,
+                           Check::Relative, br.second, 0});
+        }
+    }
+}
+
+/** the cross sections by each integration method. */
+void crossSections(std::shared_ptr<fchiggs::PartonDensity> pdf,
+                   const unsigned int n, std::vector<Quantity> *qs) {
+    const std::vector<std::pair<std::string, fchiggs::Method>> methods{
+        {"mc", fchiggs::Method::MC},
+        {"qmc", fchiggs::Method::QMC},
+        {"stratified", fchiggs::Method::Stratified}};
+    for (const auto &proc : PROCESSES) {
+        for (const auto &p : POINTS) {
+            const fchiggs::Production prod{
+                proc.second, pdf, SBEAM, p.mh,
+                fchiggs::Angles{p.tan_beta, p.cos_alpha_beta}};
+            for (const auto &method : methods) {
+                const auto sigma = fchiggs::integrate(prod, n, method.second);
+                qs->push_back({"sigma/" + proc.first + '/' + label(p) + '/' +
+                                   method.first,
+                               Check::Pull, sigma.first, sigma.second});
+            }
+        }
+    }
+}
+
+/** removes the directory and the files in it. */
+void removeDirectory(const std::string &dir) {
+    if (DIR *d = opendir(dir.c_str())) {
+        while (const dirent *e = readdir(d)) {
+            const std::string name{e->d_name};
+            if (name != "." && name != "..") {
+                std::remove((dir + '/' + name).c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+/** a failed exact check. */
+bool fail(const std::string &what) {
+    message(appname, "failed: " + what);
+    return false;
+}
+
+/**
+ *  The merges of partial results must be exact: two runs in the cache are
+ *  combined in proportion to their events, a run with a seed already in
+ *  the entry is not counted twice, and the records of a result file are
+ *  read back bit for bit.
+ */
+bool checkMerges() {
+    char tmpl[] = "/tmp/check_regression.XXXXXX";
+    if (!mkdtemp(tmpl)) { return fail("cannot create a directory in /tmp"); }
+    const std::string dir{tmpl};
+    bool ok = true;
+
+    {
+        const fchiggs::ResultCache cache{dir};
+        fchiggs::CacheKey key{"check_regression"};
+        key.add("x", 0.1);
+        fchiggs::CacheEntry run1, run2, merged;
+        run1.sigma = 0.1234567890123;
+        run1.error = 0.0011;
+        run1.n = 300000;
+        run1.seeds = {11};
+        run2.sigma = 0.1230987654321;
+        run2.error = 0.0007;
+        run2.n = 700000;
+        run2.seeds = {12};
+
+        cache.add(key, run1, &merged);
+        cache.add(key, run2, &merged);
+        const double n1 = run1.n, n2 = run2.n, n = n1 + n2;
+        const double sigma = (n1 * run1.sigma + n2 * run2.sigma) / n;
+        const double error = std::hypot(n1 * run1.error, n2 * run2.error) / n;
+        fchiggs::CacheEntry stored;
+        if (!cache.find(key, &stored)) {
+            ok = fail("the cache entry is not found");
+        } else if (stored.sigma != sigma || stored.error != error ||
+                   stored.n != run1.n + run2.n || stored.seeds.size() != 2) {
+            ok = fail("the merge of two runs in the cache");
+        }
+
+        // the same events again.
+        cache.add(key, run1, &merged);
+        if (!cache.find(key, &stored) || stored.sigma != sigma ||
+            stored.n != run1.n + run2.n) {
+            ok = fail("a run with a known seed is counted twice");
+        }
+    }
+
+    {
+        const std::string fname = dir + "/results.fcr";
+        fchiggs::Record rec1{fchiggs::Source::PphbNeutral, 300.0, 1.0, 0.05};
+        rec1.sigma = 0.1 / 3.0;
+        rec1.error = std::sqrt(2.0) * 1.0e-4;
+        rec1.n = 123456789;
+        rec1.seed = 0x9e3779b97f4a7c15ULL;
+        fchiggs::Record rec2{fchiggs::Source::HdecayCharged, 800.0, 5.0, 0.2};
+        rec2.br_charged.fill(1.0 / 7.0);
+        fchiggs::Record rec3{fchiggs::Source::HdecayNeutral, 300.0, 1.0, 0.05};
+        rec3.mzp = 400.0 / 3.0;
+        rec3.gzpx = 0.01;
+        rec3.mu = 200.0;
+        rec3.vs = 1000.0;
+        rec3.br_neutral.fill(1.0 / 11.0);
+        fchiggs::appendRecord(fname, rec1);
+        fchiggs::appendRecord(fname, rec2);
+        fchiggs::appendRecord(fname, rec3);
+        const auto recs = fchiggs::readRecords(fname);
+        if (recs.size() != 3 ||
+            std::memcmp(&recs[0].sigma, &rec1.sigma, sizeof(double)) != 0 ||
+            std::memcmp(&recs[0].error, &rec1.error, sizeof(double)) != 0 ||
+            recs[0].n != rec1.n || recs[0].seed != rec1.seed ||
+            recs[1].br_charged != rec2.br_charged ||
+            recs[2].mzp != rec3.mzp || recs[2].gzpx != rec3.gzpx ||
+            recs[2].mu != rec3.mu || recs[2].vs != rec3.vs ||
+            recs[2].br_neutral != rec3.br_neutral) {
+            ok = fail("the records of a result file are not read back");
+        }
+    }
+
+    {
+        // the text of a single point, as before the result files.
+        const fchiggs::Angles ang{5.0, 0.2};
+        const fchiggs::Hdown cdown{ang};
+        const fchiggs::ChargedHiggsDecayWidth hdecay{
+            800.0, MHSM, fchiggs::Hup{ang, Y33U}, fchiggs::VHd{cdown}, ang};
+        fchiggs::Record rec{fchiggs::Source::HdecayCharged, 800.0, 5.0, 0.2};
+        rec.setBR(hdecay);
+        std::ostringstream text, legacy;
+        fchiggs::writeText(text, rec);
+        legacy << hdecay << '\n';
+        if (text.str() != legacy.str()) {
+            ok = fail("the text of a record is not that of a single point");
+        }
+    }
+
+    removeDirectory(dir);
+    return ok;
+}
+
+/** the relative difference of a and b, zero if both are. */
+double relDiff(const double a, const double b) {
+    const double scale = std::max(std::fabs(a), std::fabs(b));
+    return scale > 0 ? std::fabs(a - b) / scale : 0;
+}
+
+/**
+ *  The kernels specialized for massless quarks must agree with the general
+ *  form within RELTOL. Without the mass of q', only a range of cos(theta)
+ *  away from the collinear region is finite.
+ */
+bool checkKernels() {
+    using fchiggs::QuarkMasses;
+    bool ok = true;
+    const auto check = [&ok](const std::string &name, const double a,
+                             const double b) {
+        if (relDiff(a, b) > RELTOL) {
+            ok = fail(name + ": " + sci(a) + " against the general " + sci(b));
+        }
+    };
+    for (const double mh : {300.0, 800.0}) {
+        for (const double r : {1.01, 1.5, 4.0, 30.0}) {
+            for (const double mqout : {MB, MT}) {
+                const double shat = r * (mh + mqout) * (mh + mqout);
+                const std::string name = "massless q, m_q' = " +
+                                         std::to_string(mqout) + ", " +
+                                         std::to_string(shat);
+                const auto f =
+                    fchiggs::sigma_hat_factors<QuarkMasses::Out>(
+                        shat, mh, 0.0, mqout, 0.1);
+                const auto g =
+                    fchiggs::sigma_hat_factors(shat, mh, 0.0, mqout, 0.1);
+                check(name, f.even, g.even);
+                check(name, f.odd, g.odd);
+            }
+
+            const double shat = r * mh * mh;
+            const std::string name = "massless q and q', " +
+                                     std::to_string(shat);
+            const auto f = fchiggs::sigma_hat_factors<QuarkMasses::None>(
+                shat, mh, 0.0, 0.0, 0.1, -0.9, 0.9);
+            const auto g = fchiggs::sigma_hat_factors(shat, mh, 0.0, 0.0, 0.1,
+                                                      -0.9, 0.9);
+            check(name, f.even, g.even);
+            check(name, f.odd, g.odd);
+        }
+    }
+    return ok;
+}
+
+/** the tolerance of the PDF grid against LHAPDF. */
+constexpr double PDFTOL = 1.0e-6;
+
+/**
+ *  The PDF of mkPdf, normally the PdfGrid, must agree with LHAPDF on the
+ *  same member within PDFTOL, for every flavor at x and Q across the grid
+ *  and its flavor thresholds, and so must the weights at fixed points.
+ */
+bool checkPdfGrid() {
+    const auto pdf = fchiggs::mkPdf(PDFNAME);
+    const auto lhapdf = fchiggs::mkLhapdf(PDFNAME);
+    bool ok = true;
+    double worst = 0;
+    std::string where;
+    const auto check = [&](const std::string &name, const double a,
+                           const double b) {
+        const double d = relDiff(a, b);
+        if (d > worst) {
+            worst = d;
+            where = name;
+        }
+    };
+    for (const double x : {1.0e-5, 1.0e-4, 1.0e-3, 0.01, 0.05, 0.1, 0.2, 0.35,
+                           0.5, 0.7}) {
+        for (const double q : {2.0, 4.0, 10.0, 91.1876, 170.0, 300.0, 1000.0,
+                               5000.0}) {
+            for (const int id : {-5, -4, -3, -2, -1, 1, 2, 3, 4, 5, 21}) {
+                std::ostringstream name;
+                name << "x f(" << id << ", " << x << ", " << q << ")";
+                check(name.str(), pdf->xfxQ(id, x, q),
+                      lhapdf->xfxQ(id, x, q));
+            }
+        }
+    }
+    for (const auto &proc : PROCESSES) {
+        for (const auto &p : POINTS) {
+            const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+            const fchiggs::Production prod{proc.second, pdf, SBEAM, p.mh,
+                                           ang};
+            const fchiggs::Production prod_lhapdf{proc.second, lhapdf, SBEAM,
+                                                  p.mh, ang};
+            for (std::size_t i = 0; i != UNIFORMS.size(); ++i) {
+                const auto &u = UNIFORMS[i];
+                check("the weight of " + proc.first + " at " + label(p) +
+                          '/' + std::to_string(i),
+                      prod.weight(u), prod_lhapdf.weight(u));
+            }
+        }
+    }
+    if (worst > PDFTOL) {
+        ok = fail("the PDF of the `" + pdf->backend() +
+                  "' backend against LHAPDF: " + where +
+                  ", relative difference " + sci(worst));
+    }
+    return ok;
+}
+
+/** the tolerance of alpha_s against LHAPDF. */
+constexpr double ALPHASTOL = 1.0e-5;
+
+/**
+ *  alphaS() must agree with LHAPDF::AlphaS_ODE within ALPHASTOL at the
+ *  scales across m_b and m_t, on both sides of each, where the decoupling
+ *  makes alpha_s jump.
+ */
+bool checkAlphaS() {
+    const auto lhapdf = fchiggs::mkLhapdfAlphaS();
+    double worst = 0, where = 0;
+    for (const double q : {2.0, 4.0, 0.999 * MB, 1.001 * MB, 10.0, MZ,
+                           0.999 * MT, 1.001 * MT, 500.0, 5000.0}) {
+        const double d = relDiff(fchiggs::alphaS()(q), lhapdf->alphasQ(q));
+        if (d > worst) {
+            worst = d;
+            where = q;
+        }
+    }
+    if (worst > ALPHASTOL) {
+        std::ostringstream msg;
+        msg << "alpha_s against LHAPDF: Q = " << where
+            << ", relative difference " << sci(worst);
+        return fail(msg.str());
+    }
+    return true;
+}
+
+/**
+ *  The adaptation of the \hat{s} channels must keep the weights of the
+ *  channels when every event of an iteration has zero weight, as when the
+ *  cuts leave nothing in a small warm-up.
+ */
+bool checkChannels() {
+    bool ok = true;
+    for (const auto &proc : PROCESSES) {
+        auto channels = fchiggs::mkChannels(proc.second, 400.0, SBEAM);
+        std::vector<double> w(channels.size());
+        for (std::size_t i = 0; i != w.size(); ++i) { w[i] = i + 1.0; }
+        channels.adapt(w);
+        std::vector<double> before, after;
+        for (std::size_t i = 0; i != channels.size(); ++i) {
+            before.push_back(channels.alpha(i));
+        }
+        channels.adapt(std::vector<double>(channels.size(), 0.0));
+        for (std::size_t i = 0; i != channels.size(); ++i) {
+            after.push_back(channels.alpha(i));
+        }
+        if (after != before) {
+            ok = fail("the channels of " + proc.first +
+                      " after the weights of zero");
+        }
+    }
+    return ok;
+}
+
+/** the events of each process in the check of the heap allocations. */
+constexpr unsigned int NALLOC = 1000;
+
+/**
+ *  The weights, with and without the derivatives, must not allocate on the
+ *  heap, and neither may the integrators.
+ */
+bool checkAllocations() {
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+    bool ok = true;
+    for (const auto &proc : PROCESSES) {
+        const fchiggs::Production prod{proc.second, pdf, SBEAM, 500.0,
+                                       fchiggs::Angles{2.0, 0.1}};
+        const fchiggs::AllocGuard guard{proc.first.c_str(),
+                                        fchiggs::AllocGuardMode::Off};
+        double sum = 0;
+        for (unsigned int i = 0; i != NALLOC; ++i) {
+            const fchiggs::Uniforms u{fchiggs::getRandom(),
+                                      fchiggs::getRandom()};
+            sum += prod.weight(u) + prod.weightGrad(u).value();
+        }
+        fchiggs::xsec(prod, NALLOC);
+        fchiggs::xsec_qmc(prod, NALLOC, 1);
+        if (guard.count() > 0 || std::isnan(sum)) {
+            ok = fail(std::to_string(guard.count()) + " heap allocations in " +
+                      proc.first);
+        }
+    }
+    return ok;
+}
+
+/** the intervals of the composite Simpson rules in checkControlVariates. */
+constexpr unsigned int NSIMPSON = 4096;
+/** the tolerance of the integral of the control variate. */
+constexpr double CVTOL = 1.0e-6;
+
+/** f integrated over [a, b] by the composite Simpson rule. */
+template <typename F>
+double simpson(const F &f, const double a, const double b) {
+    const double h = (b - a) / NSIMPSON;
+    double sum = f(a) + f(b);
+    for (unsigned int i = 1; i != NSIMPSON; ++i) {
+        sum += (i % 2 ? 4 : 2) * f(a + i * h);
+    }
+    return sum * h / 3;
+}
+
+/**
+ *  The integral of the control variate of p p --> H must agree within
+ *  CVTOL with an independent quadrature of the narrow-width form. The
+ *  Breit-Wigner of the width m_H/10000 is integrated in asinh of
+ *  (\hat{s} - m_H^2) / (m_H Gamma), where it is smooth, and the weights at
+ *  \hat{s} = m_H^2 in the variate of y. With the control variate, the
+ *  error from n events must be smaller than without, and the weights must
+ *  not allocate on the heap.
+ */
+bool checkControlVariates(const unsigned int n) {
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+    bool ok = true;
+    for (const auto &p : POINTS) {
+        fchiggs::Production prod{fchiggs::Process::H, pdf, SBEAM, p.mh,
+                                 fchiggs::Angles{p.tan_beta, p.cos_alpha_beta}};
+        const auto plain = fchiggs::xsec(prod, n);
+        prod.addControlVariate();
+
+        const double mh2 = p.mh * p.mh, mgamma = p.mh * p.mh / 10000.0;
+        const double bw = simpson(
+            [](const double v) { return 1 / (PI * std::cosh(v)); },
+            std::asinh((0.25 * mh2 - mh2) / mgamma),
+            std::asinh((SBEAM - mh2) / mgamma));
+        const double peak = simpson(
+            [&](const double u) {
+                return prod.dsigma(*pdf, fchiggs::InitPartons{SBEAM, mh2, u});
+            },
+            0, 1);
+        const double expected = bw * peak * PI * mgamma / SBEAM;
+        const double d = relDiff(prod.controlIntegral(), expected);
+        if (!(d <= CVTOL)) {
+            ok = fail("the integral of the control variate of p p --> H at " +
+                      label(p) + ": " + sci(prod.controlIntegral()) +
+                      " against the quadrature " + sci(expected));
+        }
+
+        const fchiggs::AllocGuard guard{"checkControlVariates",
+                                        fchiggs::AllocGuardMode::Off};
+        const auto cv = fchiggs::xsec(prod, n);
+        if (!(cv.second < plain.second) || guard.count() > 0) {
+            ok = fail("the control variate of p p --> H at " + label(p) +
+                      ": " + sci(cv.first) + " +- " + sci(cv.second) +
+                      " against " + sci(plain.first) + " +- " +
+                      sci(plain.second) + ", " +
+                      std::to_string(guard.count()) + " heap allocations");
+        }
+    }
+    return ok;
+}
+
+/**
+ *  The quantities to compare. Without the PDF, only the kernels and the
+ *  branching ratios, which the committed reference holds.
+ */
+std::vector<Quantity> compute(const unsigned int n, const bool with_pdf) {
+    std::vector<Quantity> qs;
+    kernels(&qs);
+    widths(&qs);
+    if (with_pdf) {
+        auto pdf = fchiggs::mkPdf(PDFNAME);
+        weights(pdf, &qs);
+        crossSections(pdf, n, &qs);
+    }
+    return qs;
+}
+
+bool record(const std::string &fname, const unsigned int n,
+            const bool with_pdf) {
+    std::ofstream fout{fname};
+    if (!fout) {
+        message(appname, "cannot write `" + fname + "'.");
+        return false;
+    }
+    fout << std::setprecision(17);
+    for (const auto &q : compute(n, with_pdf)) {
+        fout << q.name << ' ' << q.value << ' ' << q.error << '\n';
+    }
+    message(appname, "the reference has been saved to `" + fname + "'.");
+    return true;
+}
+
+/** whether the quantity agrees with the reference (value, error). */
+bool compare(const Quantity &q, const std::pair<double, double> &ref) {
+    std::string detail;
+    bool ok = true;
+    if (q.check == Check::Ulp) {
+        const std::int64_t d = ulps(q.value, ref.first);
+        ok = d <= MAXULP;
+        detail = std::to_string(d) + " ulp";
+    } else if (q.check == Check::Relative) {
+        const double d = ref.first == 0
+                             ? std::fabs(q.value)
+                             : std::fabs(q.value / ref.first - 1.0);
+        ok = d <= RELTOL;
+        detail = "relative difference " + sci(d);
+    } else {
+        const double err = std::hypot(q.error, ref.second);
+        const double pull =
+            err > 0 ? std::fabs(q.value - ref.first) / err
+                    : (q.value == ref.first ? 0 : HUGE_VAL);
+        ok = pull <= MAXPULL;
+        detail = "pull " + sci(pull);
+    }
+    if (!ok) {
+        message(appname, "failed: " + q.name + " = " + sci(q.value) +
+                             " (reference " + sci(ref.first) + "), " + detail);
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    const bool recording = argc > 1 && std::string{argv[1]} == "record";
+    const int iarg = recording ? 2 : 1;
+    if (argc > iarg + 2) {
+        std::cerr << "Usage: " << appname << " [record] [<reference> [n]]\n";
+        return 1;
+    }
+    // without a file, the committed reference, which has no PDF in it.
+    const bool with_pdf = argc > iarg;
+    const std::string fname{with_pdf ? argv[iarg] : REFERENCE};
+    const unsigned int n = argc == iarg + 2 ? std::atoi(argv[iarg + 1]) : N;
+
+    if (recording) {
+        return record(fname, n, with_pdf) ? 0 : 1;
+    }
+
+    std::ifstream fin{fname};
+    if (!fin) {
+        message(appname, "cannot read `" + fname + "'.");
+        return 1;
+    }
+    std::map<std::string, std::pair<double, double>> refs;
+    std::string line;
+    while (std::getline(fin, line)) {
+        std::istringstream is{line};
+        std::string name, value, error;
+        if (is >> name >> value >> error) {
+            refs[name] = {std::strtod(value.c_str(), nullptr),
+                          std::strtod(error.c_str(), nullptr)};
+        }
+    }
+
+    unsigned int nfailed = 0, nchecked = 7;
+    if (!checkMerges()) { ++nfailed; }
+    if (!checkKernels()) { ++nfailed; }
+    if (!checkChannels()) { ++nfailed; }
+    if (!checkAllocations()) { ++nfailed; }
+    if (!checkPdfGrid()) { ++nfailed; }
+    if (!checkAlphaS()) { ++nfailed; }
+    if (!checkControlVariates(n)) { ++nfailed; }
+    for (const auto &q : compute(n, with_pdf)) {
+        ++nchecked;
+        const auto ref = refs.find(q.name);
+        if (ref == refs.end()) {
+            message(appname, "failed: " + q.name + " is not in the reference");
+            ++nfailed;
+        } else if (!compare(q, ref->second)) {
+            ++nfailed;
+        }
+    }
+    message(appname, std::to_string(nchecked - nfailed) + " of " +
+                         std::to_string(nchecked) + " checks passed.");
+    return nfailed == 0 ? 0 : 1;
+}
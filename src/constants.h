@@ -54,6 +54,9 @@ constexpr double VEW2 = 1.0 / (SQRT2 * GF);
 
 const double VEW = std::sqrt(VEW2);
 
+/** the top Yukawa coupling of the second Higgs doublet */
+const double Y33U = SQRT2 * MT / VEW;
+
 /** alpha_s (MZ) */
 constexpr double ALPHAS = 0.118;
 
@@ -0,0 +1,312 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "alpha_s.h"
+#include "angles.h"
+#include "constants.h"
+#include "couplings.h"
+#include "cuts.h"
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "pdf.h"
+#include "user_interface.h"
+#include "xsec.h"
+
+using std::to_string;
+
+constexpr char appname[] = "contour";
+
+constexpr double ECM = 14000.0;
+constexpr double SBEAM = ECM * ECM;
+constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
+constexpr unsigned int N = 800000;
+constexpr unsigned int NH = 8500000;  // for p p --> H
+constexpr double MHSM = 125.0;
+constexpr double MZP = 400.0;
+constexpr double GZPX = 0.01;
+constexpr double MU = 200.0;
+constexpr double VS = 1000.0;
+
+/** the deepest refinement of the initial cells. */
+constexpr unsigned int MAXDEPTH = 10;
+/** a value is on one side of the limit if it is NSIGMA errors away. */
+constexpr double NSIGMA = 2.0;
+
+/** sigma x BR - limit and its error at (m_H, y). */
+using Quantity = std::function<std::pair<double, double>(const double,
+                                                         const double)>;
+
+using Node = std::pair<unsigned int, unsigned int>;
+
+struct Cell {
+    unsigned int ix, iy, size;  // in units of the finest spacing
+};
+
+double branchingRatio(const std::vector<std::pair<std::string, double>> &brs,
+                      const std::string &mode) {
+    for (const auto &br : brs) {
+        if (br.first == mode) { return br.second; }
+    }
+    std::cerr << appname << ": unknown decay mode `" << mode << "'\n";
+    std::exit(1);
+}
+
+double brNeutral(const double mh, const fchiggs::Angles &ang,
+                 const std::string &mode) {
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    fchiggs::HQuartic lambda_h{MHSM, mh, fchiggs::Mu(MU), fchiggs::Vs(VS),
+                               ang};
+    const fchiggs::HiggsDecayWidth hdecay{mh,
+                                          MHSM,
+                                          MZP,
+                                          fchiggs::alphaS()(mh),
+                                          fchiggs::GZPX(GZPX),
+                                          fchiggs::GH3(lambda_h.trilinear()),
+                                          cup,
+                                          cdown,
+                                          ang};
+    return branchingRatio(hdecay.branchingRatios(), mode);
+}
+
+double brCharged(const double mh, const fchiggs::Angles &ang,
+                 const std::string &mode) {
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    const fchiggs::ChargedHiggsDecayWidth hdecay{mh, MHSM, cup,
+                                                 fchiggs::VHd{cdown}, ang};
+    return branchingRatio(hdecay.branchingRatios(), mode);
+}
+
+/** the scan of sigma x BR - limit on the lattice of the finest cells. */
+class Scan {
+private:
+    Quantity eval_;
+    std::array<double, 2> lo_, step_;
+    std::map<Node, std::pair<double, double>> values_;
+
+public:
+    Scan(Quantity eval, const std::array<double, 2> &lo,
+         const std::array<double, 2> &hi, const unsigned int n)
+        : eval_{eval}, lo_(lo) {
+        for (int i = 0; i != 2; ++i) {
+            step_[i] = (hi[i] - lo[i]) / (n << MAXDEPTH);
+        }
+    }
+
+    std::size_t size() const { return values_.size(); }
+
+    double x(const unsigned int ix) const { return lo_[0] + ix * step_[0]; }
+    double y(const unsigned int iy) const { return lo_[1] + iy * step_[1]; }
+
+    const std::pair<double, double> &value(const Node &node) {
+        auto it = values_.find(node);
+        if (it == values_.end()) {
+            const auto v = eval_(x(node.first), y(node.second));
+            it = values_.emplace(node, v).first;
+        }
+        return it->second;
+    }
+
+    /** true if the limit may cross the cell within the errors. */
+    bool crosses(const Cell &c) {
+        bool above = true, below = true;
+        for (const auto &node : corners(c)) {
+            const auto &v = value(node);
+            above = above && v.first - NSIGMA * v.second > 0;
+            below = below && v.first + NSIGMA * v.second < 0;
+        }
+        return !above && !below;
+    }
+
+    /** the segments of the contour of the central values in the cell. */
+    std::vector<std::array<double, 4>> segments(const Cell &c);
+
+    void writePoints(std::ostream &os) const;
+
+    static std::array<Node, 4> corners(const Cell &c) {
+        return {{{c.ix, c.iy},
+                 {c.ix + c.size, c.iy},
+                 {c.ix + c.size, c.iy + c.size},
+                 {c.ix, c.iy + c.size}}};
+    }
+};
+
+std::vector<std::array<double, 4>> Scan::segments(const Cell &c) {
+    const auto nodes = corners(c);
+    std::vector<std::pair<double, double>> cuts;
+    for (int i = 0; i != 4; ++i) {
+        const Node &a = nodes[i], &b = nodes[(i + 1) % 4];
+        const double fa = value(a).first, fb = value(b).first;
+        if ((fa < 0) == (fb < 0)) { continue; }
+        const double t = fa / (fa - fb);  // linear interpolation on the edge
+        cuts.emplace_back(x(a.first) + t * (x(b.first) - x(a.first)),
+                          y(a.second) + t * (y(b.second) - y(a.second)));
+    }
+    std::vector<std::array<double, 4>> segs;
+    for (std::size_t i = 0; i + 1 < cuts.size(); i += 2) {
+        segs.push_back({{cuts[i].first, cuts[i].second, cuts[i + 1].first,
+                         cuts[i + 1].second}});
+    }
+    return segs;
+}
+
+void Scan::writePoints(std::ostream &os) const {
+    os << std::scientific << std::setprecision(6);
+    for (const auto &v : values_) {
+        os << std::setw(14) << x(v.first.first) << std::setw(14)
+           << y(v.first.second) << std::setw(14) << v.second.first
+           << std::setw(14) << v.second.second << '\n';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 14) {
+        std::cerr << "Usage: " << appname
+                  << " <process> <decay mode> <limit (pb)> <tb|cab>"
+                     " <m_H min> <m_H max> <y min> <y max> <fixed>"
+                     " <n> <max evaluations> <points output>"
+                     " <contour output>\n"
+                  << "  process: pph_neutral, pphb_neutral, ppht_charged or"
+                     " pphb_charged\n"
+                  << "  decay mode: a mode of the H (H^\\pm) decays, or"
+                     " `none' for the cross section\n"
+                  << "  tb: y = tan(beta) at fixed cos(alpha-beta),"
+                     " cab: y = cos(alpha-beta) at fixed tan(beta)\n";
+        return 1;
+    }
+
+    const std::string process{argv[1]}, mode{argv[2]}, plane{argv[4]};
+    const double limit = std::atof(argv[3]);
+    const std::array<double, 2> lo{{std::atof(argv[5]), std::atof(argv[7])}};
+    const std::array<double, 2> hi{{std::atof(argv[6]), std::atof(argv[8])}};
+    const double fixed = std::atof(argv[9]);
+    const auto n = static_cast<unsigned int>(std::atoi(argv[10]));
+    const auto max_eval = static_cast<std::size_t>(std::atol(argv[11]));
+    if (plane != "tb" && plane != "cab") {
+        std::cerr << appname << ": unknown plane `" << plane << "'\n";
+        return 1;
+    }
+    if (n == 0) {
+        std::cerr << appname << ": the number of cells must be positive\n";
+        return 1;
+    }
+    // the corners of the initial cells are all evaluated.
+    const std::size_t ncorner = (n + 1ul) * (n + 1ul);
+    if (max_eval < ncorner) {
+        std::cerr << appname << ": the evaluations must be at least "
+                  << ncorner << " for " << n << " x " << n << " cells\n";
+        return 1;
+    }
+
+    fchiggs::Process proc;
+    unsigned int nevent = N;
+    bool neutral = true;
+    if (process == "pph_neutral") {
+        proc = fchiggs::Process::H;
+        nevent = NH;
+    } else if (process == "pphb_neutral") {
+        proc = fchiggs::Process::Hb;
+    } else if (process == "ppht_charged") {
+        proc = fchiggs::Process::HtCharged;
+        neutral = false;
+    } else if (process == "pphb_charged") {
+        proc = fchiggs::Process::HbCharged;
+        neutral = false;
+    } else {
+        std::cerr << appname << ": unknown process `" << process << "'\n";
+        return 1;
+    }
+
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+    const auto method = fchiggs::integrationMethod();
+    const auto cuts = fchiggs::fiducialCuts();
+    if (cuts.active()) { message(appname, "cuts: " + cuts.str()); }
+    const bool tb_plane = plane == "tb";
+    const Quantity eval = [&](const double mh, const double y) {
+        const fchiggs::Angles ang{tb_plane ? y : fixed, tb_plane ? fixed : y};
+        const fchiggs::Production prod{proc, pdf, SBEAM, mh, ang, cuts};
+        const auto sigma = fchiggs::integrate(prod, nevent, method);
+        double br = 1.0;
+        if (mode != "none") {
+            br = neutral ? brNeutral(mh, ang, mode) : brCharged(mh, ang, mode);
+        }
+        return std::make_pair(sigma.first * br - limit, sigma.second * br);
+    };
+
+    // breadth first, so that the refinement is even when the cap is hit.
+    message(appname, "scanning " + to_string(n) + " x " + to_string(n) +
+                         " cells ...");
+    Scan scan{eval, lo, hi, n};
+    std::deque<Cell> queue;
+    for (unsigned int i = 0; i != n; ++i) {
+        for (unsigned int j = 0; j != n; ++j) {
+            queue.push_back({i << MAXDEPTH, j << MAXDEPTH, 1u << MAXDEPTH});
+        }
+    }
+    // the corners of the initial cells come first, so that crosses never
+    // evaluates a node after the cap is checked.
+    for (unsigned int i = 0; i <= n; ++i) {
+        for (unsigned int j = 0; j <= n; ++j) {
+            scan.value({i << MAXDEPTH, j << MAXDEPTH});
+        }
+    }
+    std::vector<Cell> leaves;
+    while (!queue.empty()) {
+        const Cell c = queue.front();
+        queue.pop_front();
+        // a split needs up to five more evaluations.
+        if (!scan.crosses(c) || c.size == 1 || scan.size() + 5 > max_eval) {
+            leaves.push_back(c);
+            continue;
+        }
+        // the corners of the sub-cells are evaluated now, so that the
+        // evaluations never exceed the cap.
+        const unsigned int h = c.size / 2;
+        scan.value({c.ix + h, c.iy});
+        scan.value({c.ix, c.iy + h});
+        scan.value({c.ix + h, c.iy + h});
+        scan.value({c.ix + c.size, c.iy + h});
+        scan.value({c.ix + h, c.iy + c.size});
+        queue.push_back({c.ix, c.iy, h});
+        queue.push_back({c.ix + h, c.iy, h});
+        queue.push_back({c.ix, c.iy + h, h});
+        queue.push_back({c.ix + h, c.iy + h, h});
+    }
+    message(appname, "... done with " + to_string(scan.size()) +
+                         " evaluations.");
+
+    std::ofstream fpoints{argv[12]};
+    fpoints << "# m_H y sigma*BR-limit error\n";
+    scan.writePoints(fpoints);
+    message(appname, "the points have been saved to `" +
+                         std::string(argv[12]) + "'.");
+
+    std::ofstream fcontour{argv[13]};
+    fcontour << "# x1 y1 x2 y2\n" << std::scientific << std::setprecision(6);
+    for (const auto &c : leaves) {
+        for (const auto &s : scan.segments(c)) {
+            for (const auto v : s) { fcontour << std::setw(14) << v; }
+            fcontour << '\n';
+        }
+    }
+    message(appname, "the contour has been saved to `" +
+                         std::string(argv[13]) + "'.");
+}
@@ -10,29 +10,33 @@
 #include <cmath>
 #include "angles.h"
 #include "constants.h"
+#include "dual.h"
 
 namespace fchiggs {
-double Hup::calc_h33u(const Angles &ang, const double y33u) {
-    double h33u =
+template <typename T>
+T BasicHup<T>::calc_h33u(const BasicAngles<T> &ang, const double y33u) {
+    T h33u =
         1.0 -
         VEW2 * ang.cos_beta() * ang.cos_beta() * y33u * y33u / (2.0 * MT2);
     h33u *= SQRT2 * MT / (VEW * ang.sin_beta());
     return h33u;
 }
 
-void Hdown::init(const Angles &ang) {
-    const double cfac = SQRT2 * MB / (VEW * ang.sin_beta());
+template <typename T>
+void BasicHdown<T>::init(const BasicAngles<T> &ang) {
+    const T cfac = SQRT2 * MB / (VEW * ang.sin_beta());
     h13d_ = cfac * (VUD * VUB + VCD * VCB);
     h23d_ = cfac * (VUS * VUB + VCS * VCB);
     h33d_ = cfac * (VUB * VUB + VCB * VCB);
 }
 
-void HQuartic::init_lambda(const double mh1, const double mh2, const double mu,
-                           const double vs) {
-    double sin_alpha_sq = std::pow(ang_.sin_alpha(), 2);
-    double cos_alpha_sq = std::pow(ang_.cos_alpha(), 2);
-    double sin_beta_sq = std::pow(ang_.sin_beta(), 2);
-    double cos_beta_sq = std::pow(ang_.cos_beta(), 2);
+template <typename T>
+void BasicHQuartic<T>::init_lambda(const double mh1, const double mh2,
+                                   const double mu, const double vs) {
+    T sin_alpha_sq = ang_.sin_alpha() * ang_.sin_alpha();
+    T cos_alpha_sq = ang_.cos_alpha() * ang_.cos_alpha();
+    T sin_beta_sq = ang_.sin_beta() * ang_.sin_beta();
+    T cos_beta_sq = ang_.cos_beta() * ang_.cos_beta();
 
     double mh1_sq = mh1 * mh1, mh2_sq = mh2 * mh2;
     double mu_vs = SQRT2 * mu * vs;
@@ -49,19 +53,27 @@ void HQuartic::init_lambda(const double mh1, const double mh2, const double mu,
         (8 * VEW2 * ang_.sin_beta() * ang_.cos_beta());
 }
 
-double HQuartic::trilinear() const {
-    double term1 = lambda1_ * ang_.sin_alpha() * ang_.cos_beta() +
-                   lambda2_ * ang_.cos_alpha() * ang_.sin_beta();
+template <typename T>
+T BasicHQuartic<T>::trilinear() const {
+    T term1 = lambda1_ * ang_.sin_alpha() * ang_.cos_beta() +
+              lambda2_ * ang_.cos_alpha() * ang_.sin_beta();
     term1 *= 6 * ang_.sin_alpha() * ang_.cos_alpha();
 
-    double cos_2alpha =
-        std::pow(ang_.cos_alpha(), 2) - std::pow(ang_.sin_alpha(), 2);
-    double cos_alpha_beta =
+    T cos_2alpha = ang_.cos_alpha() * ang_.cos_alpha() -
+                   ang_.sin_alpha() * ang_.sin_alpha();
+    T cos_alpha_beta =
         ang_.cos_alpha() * ang_.cos_beta() - ang_.sin_alpha() * ang_.sin_beta();
 
-    double term2 = 3 * cos_alpha_beta * cos_2alpha - ang_.cos_alpha_beta();
+    T term2 = 3 * cos_alpha_beta * cos_2alpha - ang_.cos_alpha_beta();
     term2 *= lambda34_;
 
     return term1 + term2;
 }
+
+template class BasicHup<double>;
+template class BasicHup<Grad>;
+template class BasicHdown<double>;
+template class BasicHdown<Grad>;
+template class BasicHQuartic<double>;
+template class BasicHQuartic<Grad>;
 }  // namespace fchiggs
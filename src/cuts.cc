@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "cuts.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "utils.h"
+
+namespace fchiggs {
+bool FiducialCuts::active() const {
+    return pt_min_ > 0 || std::isfinite(eta_q_max_) ||
+           std::isfinite(y_h_max_);
+}
+
+CosRange FiducialCuts::range(const double shat, const double y,
+                             const double mh, const double mqout) const {
+    CosRange r{-1, 1};
+    const double mh2 = mh * mh, mqout2 = mqout * mqout;
+    const double e = 2 * std::sqrt(shat);
+    const double p = lambda12(shat, mh2, mqout2) / e;
+
+    // p_T = p sin(theta)
+    if (pt_min_ > 0) {
+        if (pt_min_ >= p) { return {0, 0}; }
+        const double c = std::sqrt(1 - pt_min_ * pt_min_ / (p * p));
+        r = {std::max(r.lo, -c), std::min(r.hi, c)};
+    }
+
+    // y_H = y + atanh(p cos(theta) / E_H), which increases with cos(theta).
+    if (std::isfinite(y_h_max_)) {
+        const double eh = (shat + mh2 - mqout2) / e;
+        r.lo = std::max(r.lo, eh / p * std::tanh(-y_h_max_ - y));
+        r.hi = std::min(r.hi, eh / p * std::tanh(y_h_max_ - y));
+    }
+
+    // |eta| < eta_max of q' at cos(theta') = -cos(theta) is
+    // p_z^2 <= sinh^2(eta_max) p_T^2, a quadratic inequality in cos(theta').
+    if (std::isfinite(eta_q_max_) && !r.empty()) {
+        const double eq = (shat - mh2 + mqout2) / e;
+        const double ch = std::cosh(y), sh = std::sinh(y);
+        const double s2 = std::pow(std::sinh(eta_q_max_), 2);
+        const double a = p * p * (ch * ch + s2);
+        const double b = 2 * p * eq * ch * sh;
+        const double c = eq * eq * sh * sh - s2 * p * p;
+        const double disc = b * b - 4 * a * c;
+        if (disc <= 0) { return {0, 0}; }
+        // the roots without cancellations.
+        const double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+        double c1 = q / a, c2 = c / q;
+        if (c1 > c2) { std::swap(c1, c2); }
+        r = {std::max(r.lo, -c2), std::min(r.hi, -c1)};
+    }
+    return r;
+}
+
+bool FiducialCuts::accept(const double y) const {
+    return pt_min_ <= 0 && std::fabs(y) <= y_h_max_;
+}
+
+std::string FiducialCuts::str() const {
+    std::ostringstream os;
+    os << std::setprecision(17);
+    if (pt_min_ > 0) { os << "pt=" << pt_min_ << ','; }
+    if (std::isfinite(eta_q_max_)) { os << "eta=" << eta_q_max_ << ','; }
+    if (std::isfinite(y_h_max_)) { os << "yh=" << y_h_max_ << ','; }
+    std::string s = os.str();
+    if (s.empty()) { return "none"; }
+    s.pop_back();
+    return s;
+}
+
+FiducialCuts fiducialCuts() {
+    const char *cuts = std::getenv("FCHIGGS_CUTS");
+    if (!cuts) { return {}; }
+
+    double pt_min = 0, eta_q_max = HUGE_VAL, y_h_max = HUGE_VAL;
+    std::istringstream is{cuts};
+    std::string item;
+    while (std::getline(is, item, ',')) {
+        const auto eq = item.find('=');
+        const std::string name = item.substr(0, eq);
+        const double v =
+            eq == std::string::npos ? 0 : std::atof(item.c_str() + eq + 1);
+        if (name == "pt") {
+            pt_min = v;
+        } else if (name == "eta") {
+            eta_q_max = v;
+        } else if (name == "yh") {
+            y_h_max = v;
+        } else if (!name.empty()) {
+            std::cerr << "fchiggs: unknown cut `" << name
+                      << "' in FCHIGGS_CUTS is ignored.\n";
+        }
+    }
+    return {pt_min, eta_q_max, y_h_max};
+}
+}  // namespace fchiggs
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_CUTS_H_
+#define FCHIGGS_SRC_CUTS_H_
+
+#include <limits>
+#include <string>
+
+namespace fchiggs {
+/** an interval of cos(theta). It is empty if lo >= hi. */
+struct CosRange {
+    double lo, hi;
+
+    bool empty() const { return !(lo < hi); }
+};
+
+/**
+ *  Fiducial cuts on H and the outgoing quark q' of p p --> H (+ q') in the
+ *  lab frame:
+ *
+ *    pt_min:    the minimum transverse momentum of H and q', which are
+ *               equal at the leading order,
+ *    eta_q_max: the maximum |eta| of q',
+ *    y_h_max:   the maximum |y| of H.
+ *
+ *  At a partonic point (\hat{s}, y), each cut of a 2 --> 2 process keeps
+ *  an interval of cos(theta) of H in the partonic CM frame, with theta
+ *  measured from the quark of x1. The cuts are thus applied exactly by
+ *  integrating cos(theta) analytically over the intersection, and the
+ *  points where it is empty are rejected before any PDF is evaluated.
+ *  Since H has no transverse momentum in p p --> H, pt_min > 0 rejects
+ *  all of it. The cuts are symmetric under z --> -z, as they must be for
+ *  the parton from x1 to stand for either proton.
+ */
+class FiducialCuts {
+private:
+    double pt_min_, eta_q_max_, y_h_max_;
+
+public:
+    /** no cuts. */
+    FiducialCuts()
+        : pt_min_{0},
+          eta_q_max_{std::numeric_limits<double>::infinity()},
+          y_h_max_{std::numeric_limits<double>::infinity()} {}
+    FiducialCuts(const double pt_min, const double eta_q_max,
+                 const double y_h_max)
+        : pt_min_{pt_min}, eta_q_max_{eta_q_max}, y_h_max_{y_h_max} {}
+
+    /** whether any cut is set. */
+    bool active() const;
+
+    /**
+     *  The accepted cos(theta) of H in q g --> q' H at \hat{s} and the
+     *  rapidity y of the partonic CM frame in the lab frame.
+     */
+    CosRange range(const double shat, const double y, const double mh,
+                   const double mqout) const;
+
+    /** whether H of p p --> H at the rapidity y is accepted. */
+    bool accept(const double y) const;
+
+    /** `pt=..,eta=..,yh=..' with the cuts set, or `none'. */
+    std::string str() const;
+};
+
+/**
+ *  The cuts from the environment variable FCHIGGS_CUTS, such as
+ *  `pt=30,eta=2.5,yh=2.5' (GeV for pt). Unknown names are reported to
+ *  stderr and ignored.
+ */
+FiducialCuts fiducialCuts();
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_CUTS_H_
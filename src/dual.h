@@ -0,0 +1,200 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_DUAL_H_
+#define FCHIGGS_SRC_DUAL_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+
+namespace fchiggs {
+/**
+ *  Dual numbers for the forward-mode automatic differentiation: a value and
+ *  its derivatives with respect to N parameters.
+ */
+template <std::size_t N>
+class Dual {
+private:
+    double v_;
+    std::array<double, N> d_;
+
+public:
+    Dual() : v_{0.0}, d_{} {}
+    Dual(const double v) : v_{v}, d_{} {}  // a constant
+    /** the i-th parameter itself. */
+    Dual(const double v, const std::size_t i) : v_{v}, d_{} { d_[i] = 1.0; }
+
+    double value() const { return v_; }
+    double d(const std::size_t i) const { return d_[i]; }
+
+    Dual &operator+=(const Dual &x) {
+        v_ += x.v_;
+        for (std::size_t i = 0; i != N; ++i) { d_[i] += x.d_[i]; }
+        return *this;
+    }
+    Dual &operator-=(const Dual &x) {
+        v_ -= x.v_;
+        for (std::size_t i = 0; i != N; ++i) { d_[i] -= x.d_[i]; }
+        return *this;
+    }
+    Dual &operator*=(const Dual &x) {
+        for (std::size_t i = 0; i != N; ++i) {
+            d_[i] = d_[i] * x.v_ + v_ * x.d_[i];
+        }
+        v_ *= x.v_;
+        return *this;
+    }
+    Dual &operator/=(const Dual &x) {
+        const double inv = 1.0 / x.v_;
+        v_ *= inv;
+        for (std::size_t i = 0; i != N; ++i) {
+            d_[i] = (d_[i] - v_ * x.d_[i]) * inv;
+        }
+        return *this;
+    }
+    Dual &operator*=(const double x) {
+        v_ *= x;
+        for (auto &di : d_) { di *= x; }
+        return *this;
+    }
+    Dual &operator/=(const double x) { return *this *= 1.0 / x; }
+
+    Dual operator-() const { return Dual{} -= *this; }
+
+    /** the function of the value with the derivative df at the value. */
+    Dual chain(const double f, const double df) const {
+        Dual r{f};
+        for (std::size_t i = 0; i != N; ++i) { r.d_[i] = df * d_[i]; }
+        return r;
+    }
+};
+
+/** the gradient with respect to (tan(beta), cos(alpha-beta)). */
+using Grad = Dual<2>;
+
+inline double value(const double x) { return x; }
+
+template <std::size_t N>
+double value(const Dual<N> &x) {
+    return x.value();
+}
+
+/** whether the value and all the derivatives are zero. */
+inline bool isZero(const double x) { return x == 0; }
+
+template <std::size_t N>
+bool isZero(const Dual<N> &x) {
+    if (x.value() != 0) { return false; }
+    for (std::size_t i = 0; i != N; ++i) {
+        if (x.d(i) != 0) { return false; }
+    }
+    return true;
+}
+
+template <std::size_t N>
+Dual<N> operator+(Dual<N> x, const Dual<N> &y) {
+    return x += y;
+}
+template <std::size_t N>
+Dual<N> operator+(Dual<N> x, const double y) {
+    return x += y;
+}
+template <std::size_t N>
+Dual<N> operator+(const double x, Dual<N> y) {
+    return y += x;
+}
+template <std::size_t N>
+Dual<N> operator-(Dual<N> x, const Dual<N> &y) {
+    return x -= y;
+}
+template <std::size_t N>
+Dual<N> operator-(Dual<N> x, const double y) {
+    return x -= y;
+}
+template <std::size_t N>
+Dual<N> operator-(const double x, const Dual<N> &y) {
+    return -y += x;
+}
+template <std::size_t N>
+Dual<N> operator*(Dual<N> x, const Dual<N> &y) {
+    return x *= y;
+}
+template <std::size_t N>
+Dual<N> operator*(Dual<N> x, const double y) {
+    return x *= y;
+}
+template <std::size_t N>
+Dual<N> operator*(const double x, Dual<N> y) {
+    return y *= x;
+}
+template <std::size_t N>
+Dual<N> operator/(Dual<N> x, const Dual<N> &y) {
+    return x /= y;
+}
+template <std::size_t N>
+Dual<N> operator/(Dual<N> x, const double y) {
+    return x /= y;
+}
+template <std::size_t N>
+Dual<N> operator/(const double x, const Dual<N> &y) {
+    return Dual<N>{x} /= y;
+}
+
+template <std::size_t N>
+bool operator<(const Dual<N> &x, const double y) {
+    return x.value() < y;
+}
+template <std::size_t N>
+bool operator>(const Dual<N> &x, const double y) {
+    return x.value() > y;
+}
+template <std::size_t N>
+bool operator<=(const Dual<N> &x, const double y) {
+    return x.value() <= y;
+}
+template <std::size_t N>
+bool operator>=(const Dual<N> &x, const double y) {
+    return x.value() >= y;
+}
+
+template <std::size_t N>
+Dual<N> sqrt(const Dual<N> &x) {
+    const double f = std::sqrt(x.value());
+    return x.chain(f, 0.5 / f);
+}
+template <std::size_t N>
+Dual<N> sin(const Dual<N> &x) {
+    return x.chain(std::sin(x.value()), std::cos(x.value()));
+}
+template <std::size_t N>
+Dual<N> cos(const Dual<N> &x) {
+    return x.chain(std::cos(x.value()), -std::sin(x.value()));
+}
+template <std::size_t N>
+Dual<N> atan(const Dual<N> &x) {
+    const double v = x.value();
+    return x.chain(std::atan(v), 1.0 / (1.0 + v * v));
+}
+template <std::size_t N>
+Dual<N> acos(const Dual<N> &x) {
+    const double v = x.value();
+    return x.chain(std::acos(v), -1.0 / std::sqrt(1.0 - v * v));
+}
+
+/** the value and the derivatives in brackets. */
+template <std::size_t N>
+std::ostream &operator<<(std::ostream &os, const Dual<N> &x) {
+    os << x.value() << " [";
+    for (std::size_t i = 0; i != N; ++i) { os << (i ? ", " : "") << x.d(i); }
+    return os << ']';
+}
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_DUAL_H_
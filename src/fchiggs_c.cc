@@ -0,0 +1,259 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "fchiggs_c.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "alpha_s.h"
+#include "angles.h"
+#include "constants.h"
+#include "couplings.h"
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "pdf.h"
+#include "xsec.h"
+
+struct fchiggs_context {
+    std::shared_ptr<fchiggs::PartonDensity> pdf;
+    double s;
+    fchiggs::Method method;
+    double mhsm, mzp, gzpx, mu, vs;
+    std::string error;
+};
+
+namespace {
+/** the fewest events of a run, enough for the 16 randomizations of QMC. */
+constexpr unsigned long MINEVENTS = 1024;
+
+const char *const BR_NEUTRAL[] = {"bq", "cc",   "bb",   "tt", "mumu", "tautau",
+                                  "ww", "zz",   "zpzp", "aa", "gg",   "hh"};
+const char *const BR_CHARGED[] = {"tb", "cb",    "ub",   "cs",
+                                  "cd", "taunu", "munu", "wh"};
+
+int fail(fchiggs_context *ctx, const int status, const std::string &msg) {
+    ctx->error = msg;
+    return status;
+}
+
+bool toProcess(const int process, fchiggs::Process *proc) {
+    switch (process) {
+    case FCHIGGS_PPH_NEUTRAL: *proc = fchiggs::Process::H; return true;
+    case FCHIGGS_PPHB_NEUTRAL: *proc = fchiggs::Process::Hb; return true;
+    case FCHIGGS_PPHT_CHARGED: *proc = fchiggs::Process::HtCharged; return true;
+    case FCHIGGS_PPHB_CHARGED: *proc = fchiggs::Process::HbCharged; return true;
+    }
+    return false;
+}
+
+/**
+ *  combines the runs in proportion to the numbers of events that each run
+ *  sampled for its estimate, which leave out the warm-up. A run has at most
+ *  as many events as integrate can take.
+ */
+std::pair<double, double> xsecToPrecision(const fchiggs::Production &prod,
+                                          const fchiggs::Method &method,
+                                          const double rel_error,
+                                          const unsigned long min_events,
+                                          const unsigned long max_events) {
+    const unsigned long maxrun = std::numeric_limits<unsigned int>::max();
+    double sum = 0, sum_err_sq = 0, nsampled = 0;
+    unsigned long ntot = 0;
+    for (unsigned long n = min_events; ntot < max_events; n *= 2) {
+        n = std::min({n, max_events - ntot, maxrun});
+        const auto result = fchiggs::integrate(prod, n, method);
+        const double m = fchiggs::sampledEvents(prod, n, method);
+        sum += m * result.first;
+        sum_err_sq += m * m * result.second * result.second;
+        nsampled += m;
+        ntot += n;
+        if (std::sqrt(sum_err_sq) <= rel_error * std::fabs(sum)) { break; }
+    }
+    return {sum / nsampled, std::sqrt(sum_err_sq) / nsampled};
+}
+
+template <typename Width>
+void fillBR(const Width &hdecay, double *br) {
+    const auto brs = hdecay.branchingRatios();
+    for (std::size_t i = 0; i != brs.size(); ++i) { br[i] = brs[i].second; }
+}
+
+void brNeutral(const fchiggs_context *ctx, const double mh,
+               const double tan_beta, const double cos_alpha_beta,
+               double *br) {
+    const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    fchiggs::HQuartic lambda_h{ctx->mhsm, mh, fchiggs::Mu(ctx->mu),
+                               fchiggs::Vs(ctx->vs), ang};
+    const fchiggs::HiggsDecayWidth hdecay{mh,
+                                          ctx->mhsm,
+                                          ctx->mzp,
+                                          fchiggs::alphaS()(mh),
+                                          fchiggs::GZPX(ctx->gzpx),
+                                          fchiggs::GH3(lambda_h.trilinear()),
+                                          cup,
+                                          cdown,
+                                          ang};
+    fillBR(hdecay, br);
+}
+
+void brCharged(const fchiggs_context *ctx, const double mh,
+               const double tan_beta, const double cos_alpha_beta,
+               double *br) {
+    const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    const fchiggs::ChargedHiggsDecayWidth hdecay{
+        mh, ctx->mhsm, cup, fchiggs::VHd{cdown}, ang};
+    fillBR(hdecay, br);
+}
+
+template <typename F>
+int brBatch(fchiggs_context *ctx, const std::size_t n, const double *mh,
+            const double *tan_beta, const double *cos_alpha_beta, double *br,
+            const std::size_t nbr, F f) {
+    if (!ctx) { return FCHIGGS_EINVAL; }
+    if (n > 0 && (!mh || !tan_beta || !cos_alpha_beta || !br)) {
+        return fail(ctx, FCHIGGS_EINVAL, "null array");
+    }
+    try {
+        for (std::size_t i = 0; i != n; ++i) {
+            f(ctx, mh[i], tan_beta[i], cos_alpha_beta[i], br + i * nbr);
+        }
+    } catch (const std::exception &e) {
+        return fail(ctx, FCHIGGS_EFAIL, e.what());
+    }
+    return FCHIGGS_OK;
+}
+}  // namespace
+
+extern "C" {
+int fchiggs_abi_version(void) { return FCHIGGS_ABI_VERSION; }
+
+fchiggs_context *fchiggs_context_new(const char *pdfname, double ecm) {
+    if (!pdfname || !(ecm > 0)) { return nullptr; }
+    try {
+        return new fchiggs_context{fchiggs::mkPdf(pdfname),
+                                   ecm * ecm,
+                                   fchiggs::Method::MC,
+                                   125.0,
+                                   400.0,
+                                   0.01,
+                                   200.0,
+                                   1000.0,
+                                   {}};
+    } catch (...) { return nullptr; }
+}
+
+void fchiggs_context_free(fchiggs_context *ctx) { delete ctx; }
+
+const char *fchiggs_last_error(const fchiggs_context *ctx) {
+    return ctx ? ctx->error.c_str() : "null context";
+}
+
+int fchiggs_set_method(fchiggs_context *ctx, int method) {
+    if (!ctx) { return FCHIGGS_EINVAL; }
+    switch (method) {
+    case FCHIGGS_MC: ctx->method = fchiggs::Method::MC; break;
+    case FCHIGGS_QMC: ctx->method = fchiggs::Method::QMC; break;
+    case FCHIGGS_STRATIFIED: ctx->method = fchiggs::Method::Stratified; break;
+    default: return fail(ctx, FCHIGGS_EINVAL, "unknown method");
+    }
+    return FCHIGGS_OK;
+}
+
+int fchiggs_set_decay_parameters(fchiggs_context *ctx, double mhsm, double mzp,
+                                 double gzpx, double mu, double vs) {
+    if (!ctx) { return FCHIGGS_EINVAL; }
+    ctx->mhsm = mhsm;
+    ctx->mzp = mzp;
+    ctx->gzpx = gzpx;
+    ctx->mu = mu;
+    ctx->vs = vs;
+    return FCHIGGS_OK;
+}
+
+int fchiggs_xsec(fchiggs_context *ctx, int process, double mh, double tan_beta,
+                 double cos_alpha_beta, double rel_error,
+                 unsigned long min_events, unsigned long max_events,
+                 double *sigma, double *error) {
+    return fchiggs_xsec_batch(ctx, process, 1, &mh, &tan_beta, &cos_alpha_beta,
+                              rel_error, min_events, max_events, sigma, error);
+}
+
+int fchiggs_xsec_batch(fchiggs_context *ctx, int process, size_t n,
+                       const double *mh, const double *tan_beta,
+                       const double *cos_alpha_beta, double rel_error,
+                       unsigned long min_events, unsigned long max_events,
+                       double *sigma, double *error) {
+    if (!ctx) { return FCHIGGS_EINVAL; }
+    fchiggs::Process proc;
+    if (!toProcess(process, &proc)) {
+        return fail(ctx, FCHIGGS_EINVAL, "unknown process");
+    }
+    if (min_events < MINEVENTS || max_events < min_events) {
+        return fail(ctx, FCHIGGS_EINVAL, "invalid numbers of events");
+    }
+    if (n > 0 && (!mh || !tan_beta || !cos_alpha_beta || !sigma || !error)) {
+        return fail(ctx, FCHIGGS_EINVAL, "null array");
+    }
+    try {
+        for (std::size_t i = 0; i != n; ++i) {
+            const fchiggs::Angles ang{tan_beta[i], cos_alpha_beta[i]};
+            const fchiggs::Production prod{proc, ctx->pdf, ctx->s, mh[i], ang};
+            const auto result = xsecToPrecision(prod, ctx->method, rel_error,
+                                                min_events, max_events);
+            sigma[i] = result.first;
+            error[i] = result.second;
+        }
+    } catch (const std::exception &e) {
+        return fail(ctx, FCHIGGS_EFAIL, e.what());
+    }
+    return FCHIGGS_OK;
+}
+
+const char *fchiggs_br_neutral_name(int i) {
+    return i >= 0 && i < FCHIGGS_NBR_NEUTRAL ? BR_NEUTRAL[i] : nullptr;
+}
+
+const char *fchiggs_br_charged_name(int i) {
+    return i >= 0 && i < FCHIGGS_NBR_CHARGED ? BR_CHARGED[i] : nullptr;
+}
+
+int fchiggs_br_neutral(fchiggs_context *ctx, double mh, double tan_beta,
+                       double cos_alpha_beta, double *br) {
+    return fchiggs_br_neutral_batch(ctx, 1, &mh, &tan_beta, &cos_alpha_beta,
+                                    br);
+}
+
+int fchiggs_br_charged(fchiggs_context *ctx, double mh, double tan_beta,
+                       double cos_alpha_beta, double *br) {
+    return fchiggs_br_charged_batch(ctx, 1, &mh, &tan_beta, &cos_alpha_beta,
+                                    br);
+}
+
+int fchiggs_br_neutral_batch(fchiggs_context *ctx, size_t n, const double *mh,
+                             const double *tan_beta,
+                             const double *cos_alpha_beta, double *br) {
+    return brBatch(ctx, n, mh, tan_beta, cos_alpha_beta, br,
+                   FCHIGGS_NBR_NEUTRAL, brNeutral);
+}
+
+int fchiggs_br_charged_batch(fchiggs_context *ctx, size_t n, const double *mh,
+                             const double *tan_beta,
+                             const double *cos_alpha_beta, double *br) {
+    return brBatch(ctx, n, mh, tan_beta, cos_alpha_beta, br,
+                   FCHIGGS_NBR_CHARGED, brCharged);
+}
+}  // extern "C"
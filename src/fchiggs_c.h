@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_FCHIGGS_C_H_
+#define FCHIGGS_SRC_FCHIGGS_C_H_
+
+/*
+ *  The C interface of lib/libfcHiggs.so.
+ *
+ *  A context holds the PDF set and the settings. A context must not be used
+ *  by several threads at the same time, but different threads may use
+ *  their own contexts concurrently. The contexts of the same PDF set share
+ *  its grid, so a context per thread costs little memory. The functions
+ *  return FCHIGGS_OK on success, and fchiggs_last_error() tells what went
+ *  wrong otherwise.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** incremented whenever the interface changes incompatibly. */
+#define FCHIGGS_ABI_VERSION 1
+
+#define FCHIGGS_NBR_NEUTRAL 12
+#define FCHIGGS_NBR_CHARGED 8
+
+enum fchiggs_status { FCHIGGS_OK = 0, FCHIGGS_EINVAL = 1, FCHIGGS_EFAIL = 2 };
+
+enum fchiggs_process {
+    FCHIGGS_PPH_NEUTRAL = 0,  /* p p --> H */
+    FCHIGGS_PPHB_NEUTRAL = 1, /* p p --> H b */
+    FCHIGGS_PPHT_CHARGED = 2, /* p p --> H^\pm t */
+    FCHIGGS_PPHB_CHARGED = 3  /* p p --> H^\pm b */
+};
+
+enum fchiggs_method { FCHIGGS_MC = 0, FCHIGGS_QMC = 1, FCHIGGS_STRATIFIED = 2 };
+
+typedef struct fchiggs_context fchiggs_context;
+
+int fchiggs_abi_version(void);
+
+/**
+ *  A new context with the LHAPDF set of the given name and the collision
+ *  energy in GeV. It is NULL if the PDF set cannot be loaded.
+ */
+fchiggs_context *fchiggs_context_new(const char *pdfname, double ecm);
+
+void fchiggs_context_free(fchiggs_context *ctx);
+
+/** the message of the last failure in the context. */
+const char *fchiggs_last_error(const fchiggs_context *ctx);
+
+int fchiggs_set_method(fchiggs_context *ctx, int method);
+
+/**
+ *  The parameters of the H decays: the SM Higgs and Z' masses, the Z'
+ *  coupling, mu and v_s. The defaults are 125, 400, 0.01, 200 and 1000.
+ */
+int fchiggs_set_decay_parameters(fchiggs_context *ctx, double mhsm, double mzp,
+                                 double gzpx, double mu, double vs);
+
+/**
+ *  The cross section and its error in pb. The number of events is doubled
+ *  from min_events until the relative error is below rel_error or the
+ *  total number of events reaches max_events, with at most UINT_MAX events
+ *  in a single run. min_events must be at least 1024.
+ */
+int fchiggs_xsec(fchiggs_context *ctx, int process, double mh, double tan_beta,
+                 double cos_alpha_beta, double rel_error,
+                 unsigned long min_events, unsigned long max_events,
+                 double *sigma, double *error);
+
+/** fchiggs_xsec at n points. */
+int fchiggs_xsec_batch(fchiggs_context *ctx, int process, size_t n,
+                       const double *mh, const double *tan_beta,
+                       const double *cos_alpha_beta, double rel_error,
+                       unsigned long min_events, unsigned long max_events,
+                       double *sigma, double *error);
+
+/** the names of the decay modes in the order of the BR arrays. */
+const char *fchiggs_br_neutral_name(int i);
+const char *fchiggs_br_charged_name(int i);
+
+/** the FCHIGGS_NBR_NEUTRAL branching ratios of H. */
+int fchiggs_br_neutral(fchiggs_context *ctx, double mh, double tan_beta,
+                       double cos_alpha_beta, double *br);
+
+/** the FCHIGGS_NBR_CHARGED branching ratios of H^\pm. */
+int fchiggs_br_charged(fchiggs_context *ctx, double mh, double tan_beta,
+                       double cos_alpha_beta, double *br);
+
+/** the branching ratios at n points, stored point by point in br. */
+int fchiggs_br_neutral_batch(fchiggs_context *ctx, size_t n, const double *mh,
+                             const double *tan_beta,
+                             const double *cos_alpha_beta, double *br);
+int fchiggs_br_charged_batch(fchiggs_context *ctx, size_t n, const double *mh,
+                             const double *tan_beta,
+                             const double *cos_alpha_beta, double *br);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FCHIGGS_SRC_FCHIGGS_C_H_
@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <iostream>
+#include <string>
+#include "results.h"
+#include "user_interface.h"
+
+constexpr char appname[] = "fcres";
+
+int usage() {
+    std::cerr << "Usage: " << appname << " text [-p] <input>\n"
+              << "       " << appname << " merge <output> <input> ...\n";
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) { return usage(); }
+    const std::string cmd{argv[1]};
+
+    // -p: the parameters of the points in the lines of the BRs.
+    const bool params = argc == 4 && std::string{argv[2]} == "-p";
+    if (cmd == "text" && (argc == 3 || params)) {
+        for (const auto &rec : fchiggs::readRecords(argv[argc - 1])) {
+            fchiggs::writeText(std::cout, rec, params);
+        }
+        return 0;
+    }
+
+    if (cmd == "merge" && argc > 3) {
+        const std::string fout{argv[2]};
+        for (int i = 3; i != argc; ++i) {
+            const auto recs = fchiggs::readRecords(argv[i]);
+            for (const auto &rec : recs) {
+                if (!fchiggs::appendRecord(fout, rec)) {
+                    message(appname, "failed to write to `" + fout + "'.");
+                    return 1;
+                }
+            }
+            message(appname, std::to_string(recs.size()) +
+                                 " records from `" + argv[i] + "'.");
+        }
+        return 0;
+    }
+
+    return usage();
+}
@@ -7,111 +7,130 @@
  */
 
 #include "gamma_h_charged.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
+#include "dual.h"
 #include "utils.h"
 
 using std::setw;
 
 namespace fchiggs {
-double gamma_qq(const double mh, const double mq1, const double mq2,
-                const double g, const double gtilde) {
+template <typename T>
+T gamma_qq(const double mh, const double mq1, const double mq2, const T &g,
+           const T &gtilde) {
     if (mh < mq1 + mq2) { return 0; }
 
     double coeff = NC * mh / (8 * PI);
 
-    double g2 = g * g, gtilde2 = gtilde * gtilde;
+    T g2 = g * g, gtilde2 = gtilde * gtilde;
     double mh_sq = mh * mh, mq1_sq = mq1 * mq1, mq2_sq = mq2 * mq2;
-    double coup = (g2 + gtilde2) * (1.0 - (mq1_sq + mq2_sq) / mh_sq) -
-                  2.0 * (g2 - gtilde2) * mq1 * mq2 / mh_sq;
+    T coup = (g2 + gtilde2) * (1.0 - (mq1_sq + mq2_sq) / mh_sq) -
+             2.0 * (g2 - gtilde2) * mq1 * mq2 / mh_sq;
     double beta = lambda12(1.0, mq1_sq / mh_sq, mq2_sq / mh_sq);
 
     return coeff * coup * beta;
 }
 
-double gamma_tb(const double mh, const Hup &hu, const VHd &v,
-                const Angles &ang) {
-    double lamL =
+template <typename T>
+T gamma_tb(const double mh, const BasicHup<T> &hu, const BasicVHd<T> &v,
+           const BasicAngles<T> &ang) {
+    T lamL =
         SQRT2 * MB * ang.tan_beta() * VTB / VEW - v.VHd33() / ang.cos_beta();
-    double lamR =
+    T lamR =
         -VTB * (SQRT2 * MT * ang.tan_beta() / VEW - hu.c33() / ang.cos_beta());
-    double g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
-    double gamma = gamma_qq(mh, MT, MB, g, gtilde);
+    T g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
+    T gamma = gamma_qq(mh, MT, MB, g, gtilde);
     return gamma;
 }
 
-double gamma_cb(const double mh, const VHd &v, const Angles &ang) {
-    double lamL =
+template <typename T>
+T gamma_cb(const double mh, const BasicVHd<T> &v, const BasicAngles<T> &ang) {
+    T lamL =
         SQRT2 * MB * ang.tan_beta() * VCB / VEW - v.VHd23() / ang.cos_beta();
-    double lamR = -VCB * SQRT2 * MC * ang.tan_beta() / VEW;
-    double g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
-    double gamma = gamma_qq(mh, MC, MB, g, gtilde);
+    T lamR = -VCB * SQRT2 * MC * ang.tan_beta() / VEW;
+    T g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
+    T gamma = gamma_qq(mh, MC, MB, g, gtilde);
     return gamma;
 }
 
-double gamma_ub(const double mh, const VHd &v, const Angles &ang) {
-    double lamL =
+template <typename T>
+T gamma_ub(const double mh, const BasicVHd<T> &v, const BasicAngles<T> &ang) {
+    T lamL =
         SQRT2 * MB * ang.tan_beta() * VUB / VEW - v.VHd13() / ang.cos_beta();
-    double lamR = 0.0;
-    double g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
-    double gamma = gamma_qq(mh, 0.0, MB, g, gtilde);
+    T lamR = 0.0;
+    T g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
+    T gamma = gamma_qq(mh, 0.0, MB, g, gtilde);
     return gamma;
 }
 
-double gamma_cs(const double mh, const Angles &ang) {
-    double lamL = 0;
-    double lamR = -SQRT2 * MC * ang.tan_beta() * VCS / VEW;
-    double g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
-    double gamma = gamma_qq(mh, 0.0, MC, g, gtilde);
+template <typename T>
+T gamma_cs(const double mh, const BasicAngles<T> &ang) {
+    T lamL = 0;
+    T lamR = -SQRT2 * MC * ang.tan_beta() * VCS / VEW;
+    T g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
+    T gamma = gamma_qq(mh, 0.0, MC, g, gtilde);
     return gamma;
 }
 
-double gamma_cd(const double mh, const Angles &ang) {
-    double lamL = 0;
-    double lamR = -SQRT2 * MC * ang.tan_beta() * VCD / VEW;
-    double g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
-    double gamma = gamma_qq(mh, 0.0, MC, g, gtilde);
+template <typename T>
+T gamma_cd(const double mh, const BasicAngles<T> &ang) {
+    T lamL = 0;
+    T lamR = -SQRT2 * MC * ang.tan_beta() * VCD / VEW;
+    T g = (lamL + lamR) / 2.0, gtilde = (lamL - lamR) / 2.0;
+    T gamma = gamma_qq(mh, 0.0, MC, g, gtilde);
     return gamma;
 }
 
-double gamma_lnu(const double mh, const double ml, const Angles &ang) {
+template <typename T>
+T gamma_lnu(const double mh, const double ml, const BasicAngles<T> &ang) {
     if (mh < ml) { return 0; }
 
     double ml2 = ml * ml;
-    double coeff = ml2 * std::pow(ang.tan_beta(), 2) * mh / (8 * PI * VEW2);
+    T coeff =
+        ml2 * ang.tan_beta() * ang.tan_beta() * mh / (8 * PI * VEW2);
     double beta = std::pow(1.0 - ml2 / (mh * mh), 2);
-    double gamma = coeff * beta;
+    T gamma = coeff * beta;
     return gamma;
 }
 
-double gamma_taunu(const double mh, const Angles &ang) {
+template <typename T>
+T gamma_taunu(const double mh, const BasicAngles<T> &ang) {
     return gamma_lnu(mh, MTAU, ang);
 }
 
-double gamma_munu(const double mh, const Angles &ang) {
+template <typename T>
+T gamma_munu(const double mh, const BasicAngles<T> &ang) {
     return gamma_lnu(mh, MMU, ang);
 }
 
-double gamma_wh(const double mh, const double mh_sm, const Angles &ang) {
+template <typename T>
+T gamma_wh(const double mh, const double mh_sm, const BasicAngles<T> &ang) {
     if (mh < mh_sm + MW) { return 0; }
 
-    double coeff =
-        G2 * std::pow(ang.cos_alpha_beta(), 2) * mh * mh * mh / (64 * PI * MW2);
+    T coeff = G2 * ang.cos_alpha_beta() * ang.cos_alpha_beta() * mh * mh * mh /
+              (64 * PI * MW2);
 
     double mh2 = mh * mh, mh_sm2 = mh_sm * mh_sm;
     double beta = std::pow(lambda12(1.0, MW2 / mh2, mh_sm2 / mh2), 3);
 
-    double gamma = coeff * beta;
+    T gamma = coeff * beta;
     return gamma;
 }
 
-void ChargedHiggsDecayWidth::init_gamma(const double mh_sm, const Hup &hu,
-                                        const VHd &v, const Angles &ang) {
+template <typename T>
+void BasicChargedHiggsDecayWidth<T>::init_gamma(const double mh_sm,
+                                                const BasicHup<T> &hu,
+                                                const BasicVHd<T> &v,
+                                                const BasicAngles<T> &ang) {
     gamma_tb_ = gamma_tb(mh_, hu, v, ang);
     gamma_cb_ = gamma_cb(mh_, v, ang);
     gamma_ub_ = gamma_ub(mh_, v, ang);
@@ -128,11 +147,24 @@ void ChargedHiggsDecayWidth::init_gamma(const double mh_sm, const Hup &hu,
     gamma_total_ += gamma_wh_;
 }
 
-void printOutput(const std::string &mode, const double br) {
+template <typename T>
+std::vector<std::pair<std::string, T>>
+BasicChargedHiggsDecayWidth<T>::branchingRatios() const {
+    return {{"tb", br_tb()},     {"cb", br_cb()},
+            {"ub", br_ub()},     {"cs", br_cs()},
+            {"cd", br_cd()},     {"taunu", br_taunu()},
+            {"munu", br_munu()}, {"wh", br_wh()}};
+}
+
+namespace {
+template <typename T>
+void printOutput(const std::string &mode, const T &br) {
     std::cout << "H^\\pm --> " + mode << ":\t" << br << '\n';
 }
+}  // namespace
 
-void ChargedHiggsDecayWidth::printBR() const {
+template <typename T>
+void BasicChargedHiggsDecayWidth<T>::printBR() const {
     printOutput("t b", br_tb());        // (2)
     printOutput("c b", br_cb());        // (3)
     printOutput("u b", br_ub());        // (4)
@@ -143,18 +175,29 @@ void ChargedHiggsDecayWidth::printBR() const {
     printOutput("W h", br_wh());        // (9)
 }
 
-std::ostream &operator<<(std::ostream &os, const ChargedHiggsDecayWidth &hdec) {
-    int width = 12;
-    int pre = 8;
-
-    os << std::right << std::fixed << std::setprecision(2) << setw(7)
-       << hdec.mh_;
-    os << std::setprecision(pre) << setw(width) << hdec.br_tb() << setw(width)
-       << hdec.br_cb() << setw(width) << hdec.br_ub() << setw(width)
-       << hdec.br_cs() << setw(width) << hdec.br_cd();
-    os << setw(width) << hdec.br_taunu() << setw(width) << hdec.br_munu();
-    os << setw(width) << hdec.br_wh();
-
+/*
+ *  The line is formatted by snprintf rather than the stream manipulators,
+ *  which are several times slower for a table of many points. The layout
+ *  is the same: %7.2f for m_H and %12.8f for each BR.
+ */
+template <typename T>
+std::ostream &operator<<(std::ostream &os,
+                         const BasicChargedHiggsDecayWidth<T> &hdec) {
+    char buf[32];
+    const auto put = [&os, &buf](const int len) {
+        os.write(buf, std::min<int>(len, sizeof buf - 1));
+    };
+    put(std::snprintf(buf, sizeof buf, "%7.2f", hdec.mh()));
+    for (const auto &br : hdec.branchingRatios()) {
+        put(std::snprintf(buf, sizeof buf, "%12.8f", value(br.second)));
+    }
     return os;
 }
+
+template class BasicChargedHiggsDecayWidth<double>;
+template class BasicChargedHiggsDecayWidth<Grad>;
+template std::ostream &operator<<(std::ostream &,
+                                  const ChargedHiggsDecayWidth &);
+template std::ostream &operator<<(std::ostream &,
+                                  const BasicChargedHiggsDecayWidth<Grad> &);
 }  // namespace fchiggs
@@ -10,44 +10,59 @@
 #define FCHIGGS_SRC_GAMMA_H_CHARGED_H_
 
 #include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "angles.h"
 #include "couplings.h"
 
 namespace fchiggs {
-class ChargedHiggsDecayWidth {
+template <typename T>
+class BasicChargedHiggsDecayWidth {
 private:
     double mh_;
-    double gamma_tb_, gamma_cb_, gamma_ub_, gamma_cs_, gamma_cd_;
-    double gamma_taunu_, gamma_munu_;
-    double gamma_wh_;
+    T gamma_tb_, gamma_cb_, gamma_ub_, gamma_cs_, gamma_cd_;
+    T gamma_taunu_, gamma_munu_;
+    T gamma_wh_;
 
-    double gamma_total_;
+    T gamma_total_;
 
 public:
-    ChargedHiggsDecayWidth() = delete;
-    ChargedHiggsDecayWidth(const double mh, const double mh_sm, const Hup &hu,
-                           const VHd &v, const Angles &ang)
+    BasicChargedHiggsDecayWidth() = delete;
+    BasicChargedHiggsDecayWidth(const double mh, const double mh_sm,
+                                const BasicHup<T> &hu, const BasicVHd<T> &v,
+                                const BasicAngles<T> &ang)
         : mh_(mh) {
         init_gamma(mh_sm, hu, v, ang);
     }
 
-    double br_tb() const { return gamma_tb_ / gamma_total_; }
-    double br_cb() const { return gamma_cb_ / gamma_total_; }
-    double br_ub() const { return gamma_ub_ / gamma_total_; }
-    double br_cs() const { return gamma_cs_ / gamma_total_; }
-    double br_cd() const { return gamma_cd_ / gamma_total_; }
-    double br_taunu() const { return gamma_taunu_ / gamma_total_; }
-    double br_munu() const { return gamma_munu_ / gamma_total_; }
-    double br_wh() const { return gamma_wh_ / gamma_total_; }
+    double mh() const { return mh_; }
 
-    void printBR() const;
+    T br_tb() const { return gamma_tb_ / gamma_total_; }
+    T br_cb() const { return gamma_cb_ / gamma_total_; }
+    T br_ub() const { return gamma_ub_ / gamma_total_; }
+    T br_cs() const { return gamma_cs_ / gamma_total_; }
+    T br_cd() const { return gamma_cd_ / gamma_total_; }
+    T br_taunu() const { return gamma_taunu_ / gamma_total_; }
+    T br_munu() const { return gamma_munu_ / gamma_total_; }
+    T br_wh() const { return gamma_wh_ / gamma_total_; }
+
+    /** the decay modes and their branching ratios in the output order. */
+    std::vector<std::pair<std::string, T>> branchingRatios() const;
 
-    friend std::ostream &operator<<(std::ostream &os,
-                                    const ChargedHiggsDecayWidth &hdec);
+    void printBR() const;
 
 private:
-    void init_gamma(const double mh_sm, const Hup &hu, const VHd &v,
-                    const Angles &ang);
+    void init_gamma(const double mh_sm, const BasicHup<T> &hu,
+                    const BasicVHd<T> &v, const BasicAngles<T> &ang);
 };
+
+using ChargedHiggsDecayWidth = BasicChargedHiggsDecayWidth<double>;
+
+/** m_H and the branching ratios, without the derivatives. */
+template <typename T>
+std::ostream &operator<<(std::ostream &os,
+                         const BasicChargedHiggsDecayWidth<T> &hdec);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_GAMMA_H_CHARGED_H_
@@ -7,25 +7,31 @@
  */
 
 #include "gamma_h_neutral.h"
+#include <algorithm>
 #include <cmath>
 #include <complex>
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
+#include "dual.h"
 
 using std::complex;
 using std::setw;
 
 namespace fchiggs {
-double gamma_bd(const double mh, const Hdown &c, const Angles &ang,
-                const DQuark &typ) {
+template <typename T>
+T gamma_bd(const double mh, const BasicHdown<T> &c, const BasicAngles<T> &ang,
+           const DQuark &typ) {
     if (mh <= MB) { return 0; }
 
-    double coeff = NC * std::pow(ang.sin_alpha_beta(), 2) /
-                   (32.0 * PI * std::pow(ang.cos_beta(), 2));
+    T coeff = NC * ang.sin_alpha_beta() * ang.sin_alpha_beta() /
+              (32.0 * PI * ang.cos_beta() * ang.cos_beta());
     if (typ == DQuark::Down) {
         coeff *= c.c13();
     } else if (typ == DQuark::Strange) {
@@ -38,50 +44,58 @@ double gamma_bd(const double mh, const Hdown &c, const Angles &ang,
     return coeff * fac;
 }
 
-double gamma_qq(const double mh, const double mq, const double lambda_q) {
+template <typename T>
+T gamma_qq(const double mh, const double mq, const T &lambda_q) {
     if (mh <= 2.0 * mq) { return 0; }
 
-    double coeff = NC * lambda_q * lambda_q / (16.0 * PI);
+    T coeff = NC * lambda_q * lambda_q / (16.0 * PI);
     double fac = mh * std::pow(1.0 - 4.0 * mq * mq / (mh * mh), 1.5);
     return coeff * fac;
 }
 
-double gamma_cc(const double mh, const Angles &ang) {
-    double lambda_c = SQRT2 * MC * ang.cos_alpha() / (VEW * ang.cos_beta());
+template <typename T>
+T gamma_cc(const double mh, const BasicAngles<T> &ang) {
+    T lambda_c = SQRT2 * MC * ang.cos_alpha() / (VEW * ang.cos_beta());
     return gamma_qq(mh, MC, lambda_c);
 }
 
-double gamma_bb(const double mh, const Hdown &c, const Angles &ang) {
-    double lambda_b = SQRT2 * MB * ang.cos_alpha() / (VEW * ang.cos_beta()) +
-                      c.c33() * ang.sin_alpha_beta() / ang.cos_beta();
+template <typename T>
+T gamma_bb(const double mh, const BasicHdown<T> &c, const BasicAngles<T> &ang) {
+    T lambda_b = SQRT2 * MB * ang.cos_alpha() / (VEW * ang.cos_beta()) +
+                 c.c33() * ang.sin_alpha_beta() / ang.cos_beta();
     return gamma_qq(mh, MB, lambda_b);
 }
 
-double gamma_tt(const double mh, const Hup &c, const Angles &ang) {
-    double lambda_t = SQRT2 * MT * ang.cos_alpha() / (VEW * ang.cos_beta()) +
-                      c.c33() * ang.sin_alpha_beta() / ang.cos_beta();
+template <typename T>
+T gamma_tt(const double mh, const BasicHup<T> &c, const BasicAngles<T> &ang) {
+    T lambda_t = SQRT2 * MT * ang.cos_alpha() / (VEW * ang.cos_beta()) +
+                 c.c33() * ang.sin_alpha_beta() / ang.cos_beta();
     return gamma_qq(mh, MT, lambda_t);
 }
 
-double gamma_ll(const double mh, const double ml, const Angles &ang) {
+template <typename T>
+T gamma_ll(const double mh, const double ml, const BasicAngles<T> &ang) {
     if (mh <= 2.0 * ml) { return 0; }
 
     double ml2 = ml * ml;
-    double coeff = ml2 * std::pow(ang.cos_alpha(), 2) /
-                   (8.0 * PI * VEW2 * std::pow(ang.cos_beta(), 2));
+    T coeff = ml2 * ang.cos_alpha() * ang.cos_alpha() /
+              (8.0 * PI * VEW2 * ang.cos_beta() * ang.cos_beta());
     double fac = mh * std::pow(1.0 - 4 * ml2 / (mh * mh), 1.5);
     return coeff * fac;
 }
 
-double gamma_mumu(const double mh, const Angles &ang) {
+template <typename T>
+T gamma_mumu(const double mh, const BasicAngles<T> &ang) {
     return gamma_ll(mh, MMU, ang);
 }
 
-double gamma_tautau(const double mh, const Angles &ang) {
+template <typename T>
+T gamma_tautau(const double mh, const BasicAngles<T> &ang) {
     return gamma_ll(mh, MTAU, ang);
 }
 
-double gamma_vv(const double mh, const double mv, const double coeff) {
+template <typename T>
+T gamma_vv(const double mh, const double mv, const T &coeff) {
     if (mh <= 2.0 * mv) { return 0; }
 
     double mh2 = mh * mh, mv2 = mv * mv;
@@ -90,23 +104,26 @@ double gamma_vv(const double mh, const double mv, const double coeff) {
     return coeff * fac;
 }
 
-double gamma_ww(const double mh, const Angles &ang) {
-    double coeff = std::pow(mh, 3) * std::pow(ang.cos_alpha_beta(), 2) /
-                   (16.0 * PI * VEW2);
+template <typename T>
+T gamma_ww(const double mh, const BasicAngles<T> &ang) {
+    T coeff = std::pow(mh, 3) * ang.cos_alpha_beta() * ang.cos_alpha_beta() /
+              (16.0 * PI * VEW2);
     return gamma_vv(mh, MW, coeff);
 }
 
-double gamma_zz(const double mh, const Angles &ang) {
-    double coeff = std::pow(mh, 3) * std::pow(ang.cos_alpha_beta(), 2) /
-                   (32.0 * PI * VEW2);
+template <typename T>
+T gamma_zz(const double mh, const BasicAngles<T> &ang) {
+    T coeff = std::pow(mh, 3) * ang.cos_alpha_beta() * ang.cos_alpha_beta() /
+              (32.0 * PI * VEW2);
     return gamma_vv(mh, MZ, coeff);
 }
 
-double gamma_zpzp(const double mh, const double mzp, const double gx,
-                  const Angles &ang) {
-    double coeff = std::pow(gx, 4) * std::pow(mh, 3) * VEW2 *
-                   std::pow(ang.sin_beta() * ang.sin_alpha(), 2) /
-                   (2592.0 * PI * MZ2 * MZ2);
+template <typename T>
+T gamma_zpzp(const double mh, const double mzp, const double gx,
+             const BasicAngles<T> &ang) {
+    T sin_ba = ang.sin_beta() * ang.sin_alpha();
+    T coeff = std::pow(gx, 4) * std::pow(mh, 3) * VEW2 * sin_ba * sin_ba /
+              (2592.0 * PI * MZ2 * MZ2);
     return gamma_vv(mh, mzp, coeff);
 }
 
@@ -132,49 +149,65 @@ complex<double> loop_1(const double tau) {
     return -1.0 / tau2 * (num1 + num2);
 }
 
-double gamma_aa(const double mh, const Hup &cup, const Hdown &cdown,
-                const Angles &ang) {
+/**
+ *  |sum_i c_i A_i|^2 for the real couplings c_i and the complex loop
+ *  amplitudes A_i, which do not depend on the couplings.
+ */
+template <typename T>
+T norm_sum(const std::vector<std::pair<T, complex<double>>> &terms) {
+    T re = 0, im = 0;
+    for (const auto &term : terms) {
+        re += term.first * term.second.real();
+        im += term.first * term.second.imag();
+    }
+    return re * re + im * im;
+}
+
+template <typename T>
+T gamma_aa(const double mh, const BasicHup<T> &cup, const BasicHdown<T> &cdown,
+           const BasicAngles<T> &ang) {
     double coeff = ALPHA * ALPHA * std::pow(mh, 3) / (256.0 * PI3 * VEW2);
 
     double mh2 = mh * mh;
-    complex<double> arg_t = NC * (4.0 / 9) * cup.c33() * VEW / (SQRT2 * MT) *
-                            loop_12(mh2 / (4.0 * MT2));
-    complex<double> arg_b = NC * (1.0 / 9) * cdown.c33() * VEW / (SQRT2 * MB) *
-                            loop_12(mh2 / (4.0 * MB2));
-    complex<double> arg_tau =
-        ang.cos_alpha() / ang.cos_beta() * loop_12(mh2 / (4.0 * MTAU2));
-    complex<double> arg_w = ang.cos_alpha_beta() * loop_1(mh2 / (4.0 * MW2));
-    double loop_fac = std::norm(arg_t + arg_b + arg_tau + arg_w);
+    T loop_fac = norm_sum<T>(
+        {{NC * (4.0 / 9) * cup.c33() * VEW / (SQRT2 * MT),
+          loop_12(mh2 / (4.0 * MT2))},
+         {NC * (1.0 / 9) * cdown.c33() * VEW / (SQRT2 * MB),
+          loop_12(mh2 / (4.0 * MB2))},
+         {ang.cos_alpha() / ang.cos_beta(), loop_12(mh2 / (4.0 * MTAU2))},
+         {ang.cos_alpha_beta(), loop_1(mh2 / (4.0 * MW2))}});
 
     return coeff * loop_fac;
 }
 
-double gamma_gg(const double mh, const Hup &cup, const Hdown &cdown,
-                const double alpha_s) {
+template <typename T>
+T gamma_gg(const double mh, const BasicHup<T> &cup, const BasicHdown<T> &cdown,
+           const double alpha_s) {
     double coeff = alpha_s * alpha_s * std::pow(mh, 3) / (72.0 * PI3 * VEW2);
 
     double mh2 = mh * mh;
-    complex<double> arg_t =
-        cup.c33() * VEW / (SQRT2 * MT) * loop_12(mh2 / (4 * MT2));
-    complex<double> arg_b =
-        cdown.c33() * VEW / (SQRT2 * MB) * loop_12(mh2 / (4 * MB2));
-    double loop_fac = (9.0 / 16) * std::norm(arg_t + arg_b);
+    T loop_fac = (9.0 / 16) * norm_sum<T>({{cup.c33() * VEW / (SQRT2 * MT),
+                                            loop_12(mh2 / (4 * MT2))},
+                                           {cdown.c33() * VEW / (SQRT2 * MB),
+                                            loop_12(mh2 / (4 * MB2))}});
 
     return coeff * loop_fac;
 }
 
-double gamma_hh(const double mh, const double mh_sm, const double ghhh) {
+template <typename T>
+T gamma_hh(const double mh, const double mh_sm, const T &ghhh) {
     if (mh <= 2.0 * mh_sm) { return 0; }
 
-    double coeff = ghhh * ghhh * VEW2 / (32.0 * PI * mh);
+    T coeff = ghhh * ghhh * VEW2 / (32.0 * PI * mh);
     double fac = std::sqrt(1.0 - 4 * mh_sm * mh_sm / (mh * mh));
     return coeff * fac;
 }
 
-void HiggsDecayWidth::init_gamma(const double mh_sm, const double mzp,
-                                 const double alpha_s, const double gx,
-                                 const double ghhh, const Hup &cup,
-                                 const Hdown &cdown, const Angles &ang) {
+template <typename T>
+void BasicHiggsDecayWidth<T>::init_gamma(
+    const double mh_sm, const double mzp, const double alpha_s,
+    const double gx, const T &ghhh, const BasicHup<T> &cup,
+    const BasicHdown<T> &cdown, const BasicAngles<T> &ang) {
     // the factor 2 is to take into account the charge conjugation.
     gamma_bd_ = 2 * gamma_bd(mh_, cdown, ang, DQuark::Down);
     gamma_bs_ = 2 * gamma_bd(mh_, cdown, ang, DQuark::Strange);
@@ -198,11 +231,26 @@ void HiggsDecayWidth::init_gamma(const double mh_sm, const double mzp,
     gamma_total_ += gamma_hh_;
 }
 
-void printOutput(const std::string &mode, const double br) {
+template <typename T>
+std::vector<std::pair<std::string, T>>
+BasicHiggsDecayWidth<T>::branchingRatios() const {
+    return {{"bq", br_bq()},     {"cc", br_cc()},
+            {"bb", br_bb()},     {"tt", br_tt()},
+            {"mumu", br_mumu()}, {"tautau", br_tautau()},
+            {"ww", br_ww()},     {"zz", br_zz()},
+            {"zpzp", br_zpzp()}, {"aa", br_aa()},
+            {"gg", br_gg()},     {"hh", br_hh()}};
+}
+
+namespace {
+template <typename T>
+void printOutput(const std::string &mode, const T &br) {
     std::cout << "H --> " + mode << ":\t" << br << '\n';
 }
+}  // namespace
 
-void HiggsDecayWidth::printBR() const {
+template <typename T>
+void BasicHiggsDecayWidth<T>::printBR() const {
     printOutput("bq (q = d, s)", br_bq());  // (2)
     printOutput("cc", br_cc());             // (3)
     printOutput("bb", br_bb());             // (4)
@@ -217,21 +265,28 @@ void HiggsDecayWidth::printBR() const {
     printOutput("hh", br_hh());             // (13)
 }
 
-std::ostream &operator<<(std::ostream &os, const HiggsDecayWidth &hdec) {
-    int width = 12;
-    int pre = 8;
-
-    os << std::right << std::fixed << std::setprecision(2) << setw(7)
-       << hdec.mh_;
-    os << std::setprecision(pre) << setw(width) << hdec.br_bq() << setw(width)
-       << hdec.br_cc() << setw(width) << hdec.br_bb() << setw(width)
-       << hdec.br_tt();
-    os << setw(width) << hdec.br_mumu() << setw(width) << hdec.br_tautau();
-    os << setw(width) << hdec.br_ww() << setw(width) << hdec.br_zz();
-    os << setw(width) << hdec.br_zpzp();
-    os << setw(width) << hdec.br_aa() << setw(width) << hdec.br_gg();
-    os << setw(width) << hdec.br_hh();
-
+/*
+ *  The line is formatted by snprintf rather than the stream manipulators,
+ *  which are several times slower for a table of many points. The layout
+ *  is the same: %7.2f for m_H and %12.8f for each BR.
+ */
+template <typename T>
+std::ostream &operator<<(std::ostream &os,
+                         const BasicHiggsDecayWidth<T> &hdec) {
+    char buf[32];
+    const auto put = [&os, &buf](const int len) {
+        os.write(buf, std::min<int>(len, sizeof buf - 1));
+    };
+    put(std::snprintf(buf, sizeof buf, "%7.2f", hdec.mh()));
+    for (const auto &br : hdec.branchingRatios()) {
+        put(std::snprintf(buf, sizeof buf, "%12.8f", value(br.second)));
+    }
     return os;
 }
+
+template class BasicHiggsDecayWidth<double>;
+template class BasicHiggsDecayWidth<Grad>;
+template std::ostream &operator<<(std::ostream &, const HiggsDecayWidth &);
+template std::ostream &operator<<(std::ostream &,
+                                  const BasicHiggsDecayWidth<Grad> &);
 }  // namespace fchiggs
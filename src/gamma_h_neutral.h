@@ -10,6 +10,9 @@
 #define FCHIGGS_SRC_GAMMA_H_NEUTRAL_H_
 
 #include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
 #include "angles.h"
 #include "couplings.h"
 #include "utils.h"
@@ -18,53 +21,64 @@ namespace fchiggs {
 using GH3 = ValueType<double>;
 using GZPX = ValueType<double>;
 
-class HiggsDecayWidth {
+template <typename T>
+class BasicHiggsDecayWidth {
 private:
     double mh_;
-    double gamma_bd_, gamma_bs_;
-    double gamma_cc_, gamma_bb_, gamma_tt_;
-    double gamma_mumu_, gamma_tautau_;
-    double gamma_ww_, gamma_zz_;
-    double gamma_zpzp_;
-    double gamma_aa_, gamma_gg_;
-    double gamma_hh_;
+    T gamma_bd_, gamma_bs_;
+    T gamma_cc_, gamma_bb_, gamma_tt_;
+    T gamma_mumu_, gamma_tautau_;
+    T gamma_ww_, gamma_zz_;
+    T gamma_zpzp_;
+    T gamma_aa_, gamma_gg_;
+    T gamma_hh_;
 
-    double gamma_total_;
+    T gamma_total_;
 
 public:
-    HiggsDecayWidth() = delete;
-    HiggsDecayWidth(const double mh, const double mh_sm, const double mzp,
-                    const double alpha_s, const GZPX &gx, const GH3 &ghhh,
-                    const Hup &cup, const Hdown &cdown, const Angles &ang)
+    BasicHiggsDecayWidth() = delete;
+    BasicHiggsDecayWidth(const double mh, const double mh_sm, const double mzp,
+                         const double alpha_s, const GZPX &gx,
+                         const ValueType<T> &ghhh, const BasicHup<T> &cup,
+                         const BasicHdown<T> &cdown, const BasicAngles<T> &ang)
         : mh_(mh) {
         init_gamma(mh_sm, mzp, alpha_s, gx.value, ghhh.value, cup, cdown, ang);
     }
 
-    double br_bd() const { return gamma_bd_ / gamma_total_; }
-    double br_bs() const { return gamma_bs_ / gamma_total_; }
-    double br_bq() const { return br_bd() + br_bs(); }
-    double br_cc() const { return gamma_cc_ / gamma_total_; }
-    double br_bb() const { return gamma_bb_ / gamma_total_; }
-    double br_tt() const { return gamma_tt_ / gamma_total_; }
-    double br_mumu() const { return gamma_mumu_ / gamma_total_; }
-    double br_tautau() const { return gamma_tautau_ / gamma_total_; }
-    double br_ww() const { return gamma_ww_ / gamma_total_; }
-    double br_zz() const { return gamma_zz_ / gamma_total_; }
-    double br_zpzp() const { return gamma_zpzp_ / gamma_total_; }
-    double br_aa() const { return gamma_aa_ / gamma_total_; }
-    double br_gg() const { return gamma_gg_ / gamma_total_; }
-    double br_hh() const { return gamma_hh_ / gamma_total_; }
+    double mh() const { return mh_; }
 
-    void printBR() const;
+    T br_bd() const { return gamma_bd_ / gamma_total_; }
+    T br_bs() const { return gamma_bs_ / gamma_total_; }
+    T br_bq() const { return br_bd() + br_bs(); }
+    T br_cc() const { return gamma_cc_ / gamma_total_; }
+    T br_bb() const { return gamma_bb_ / gamma_total_; }
+    T br_tt() const { return gamma_tt_ / gamma_total_; }
+    T br_mumu() const { return gamma_mumu_ / gamma_total_; }
+    T br_tautau() const { return gamma_tautau_ / gamma_total_; }
+    T br_ww() const { return gamma_ww_ / gamma_total_; }
+    T br_zz() const { return gamma_zz_ / gamma_total_; }
+    T br_zpzp() const { return gamma_zpzp_ / gamma_total_; }
+    T br_aa() const { return gamma_aa_ / gamma_total_; }
+    T br_gg() const { return gamma_gg_ / gamma_total_; }
+    T br_hh() const { return gamma_hh_ / gamma_total_; }
+
+    /** the decay modes and their branching ratios in the output order. */
+    std::vector<std::pair<std::string, T>> branchingRatios() const;
 
-    friend std::ostream &operator<<(std::ostream &os,
-                                    const HiggsDecayWidth &hdec);
+    void printBR() const;
 
 private:
     void init_gamma(const double mh_sm, const double mzp, const double alpha_s,
-                    const double gx, const double ghhh, const Hup &cup,
-                    const Hdown &cdown, const Angles &ang);
+                    const double gx, const T &ghhh, const BasicHup<T> &cup,
+                    const BasicHdown<T> &cdown, const BasicAngles<T> &ang);
 };
+
+using HiggsDecayWidth = BasicHiggsDecayWidth<double>;
+
+/** m_H and the branching ratios, without the derivatives. */
+template <typename T>
+std::ostream &operator<<(std::ostream &os,
+                         const BasicHiggsDecayWidth<T> &hdec);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_GAMMA_H_NEUTRAL_H_
@@ -9,23 +9,121 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <istream>
+#include <sstream>
 #include <string>
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
+#include "dual.h"
 #include "gamma_h_charged.h"
+#include "results.h"
 #include "user_interface.h"
 
 using std::to_string;
 
 constexpr char appname[] = "hdecay_charged";
 constexpr double MHSM = 125.0;
-const double Y33U = SQRT2 * MT / VEW;
+
+/** the BRs and their derivatives w.r.t. (tan(beta), cos(alpha-beta)). */
+void printGradient(const double mh, const double tan_beta,
+                   const double cos_alpha_beta) {
+    using fchiggs::Grad;
+    const fchiggs::BasicAngles<Grad> ang{Grad{tan_beta, 0},
+                                         Grad{cos_alpha_beta, 1}};
+    const fchiggs::BasicHup<Grad> cup{ang, Y33U};
+    const fchiggs::BasicVHd<Grad> vhd{fchiggs::BasicHdown<Grad>{ang}};
+    const fchiggs::BasicChargedHiggsDecayWidth<Grad> hdecay{mh, MHSM, cup, vhd,
+                                                            ang};
+    hdecay.printBR();
+}
+
+fchiggs::ChargedHiggsDecayWidth mkDecayWidth(const double mh,
+                                             const double tan_beta,
+                                             const double cos_alpha_beta) {
+    const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    return {mh, MHSM, cup, fchiggs::VHd{cdown}, ang};
+}
+
+/** the record of the point with its BRs. */
+fchiggs::Record mkRecord(const double mh, const double tan_beta,
+                         const double cos_alpha_beta,
+                         const fchiggs::ChargedHiggsDecayWidth &hdecay) {
+    fchiggs::Record rec{fchiggs::Source::HdecayCharged, mh, tan_beta,
+                        cos_alpha_beta};
+    rec.setBR(hdecay);
+    return rec;
+}
+
+/**
+ *  Reads `m_H tan(beta) cos(alpha-beta)' per line and writes the
+ *  parameters and the BRs of each point as soon as it is computed, in the
+ *  order of the input. The empty lines and those starting with `#' are
+ *  skipped, and the other lines that cannot be read are rejected.
+ */
+int batch(std::istream &is, const std::string &output) {
+    const bool binary = !output.empty() && fchiggs::isResultFile(output);
+    std::ofstream fout;
+    if (!output.empty() && !binary) {
+        fout.open(output, std::ios_base::app);
+    }
+    std::ostream &os = output.empty() ? std::cout : fout;
+
+    std::string line;
+    unsigned long nline = 0, npoint = 0;
+    while (std::getline(is, line)) {
+        ++nline;
+        std::istringstream ls{line};
+        double mh, tan_beta, cos_alpha_beta;
+        std::string rest;
+        if (!(ls >> mh)) { continue; }  // empty or a comment
+        if (!(ls >> tan_beta >> cos_alpha_beta) || ls >> rest) {
+            std::cerr << appname << ": line " << nline << " is ignored.\n";
+            continue;
+        }
+
+        const auto rec =
+            mkRecord(mh, tan_beta, cos_alpha_beta,
+                     mkDecayWidth(mh, tan_beta, cos_alpha_beta));
+        if (binary) {
+            if (!fchiggs::appendRecord(output, rec)) {
+                std::cerr << appname << ": failed to write to `" << output
+                          << "'.\n";
+                return 1;
+            }
+        } else {
+            fchiggs::writeText(os, rec, true);
+            os.flush();
+        }
+        ++npoint;
+    }
+    if (!output.empty()) {
+        message(appname, to_string(npoint) + " points have been saved to `" +
+                             output + "'.");
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
+    if (argc == 2 || argc == 3) {
+        const std::string input{argv[1]};
+        const std::string output{argc == 3 ? argv[2] : ""};
+        if (input == "-") { return batch(std::cin, output); }
+        std::ifstream fin{input};
+        if (!fin) {
+            std::cerr << appname << ": cannot read `" << input << "'.\n";
+            return 1;
+        }
+        return batch(fin, output);
+    }
     if (argc < 4 || argc > 5) {
         std::cerr << "Usage: " << appname
-                  << "<m_H (GeV>) <tan(beta)> <cos(alpha-beta)> [output]\n";
+                  << " <m_H (GeV)> <tan(beta)> <cos(alpha-beta)> [output]\n"
+                  << "       " << appname << " <points> [output]\n"
+                  << "  points: a file of `m_H tan(beta) cos(alpha-beta)'"
+                     " per line, or `-' for stdin\n";
         return 1;
     }
 
@@ -36,20 +134,29 @@ int main(int argc, char *argv[]) {
     const double cos_alpha_beta = std::atof(argv[3]);
     message(appname, "tan(beta) = " + to_string(tan_beta) +
                          ", cos(alpha-beta) = " + to_string(cos_alpha_beta));
-    fchiggs::Angles ang{tan_beta, cos_alpha_beta};
-    const fchiggs::Hup cup{ang, Y33U};
-    const fchiggs::Hdown cdown{ang};
-    const fchiggs::VHd vhd{cdown};
+    const auto hdecay = mkDecayWidth(mh, tan_beta, cos_alpha_beta);
 
-    fchiggs::ChargedHiggsDecayWidth hdecay{mh, MHSM, cup, vhd, ang};
-
-    if (argc == 4) { hdecay.printBR(); }
+    if (argc == 4) {
+        if (std::getenv("FCHIGGS_GRADIENT")) {
+            printGradient(mh, tan_beta, cos_alpha_beta);
+        } else {
+            hdecay.printBR();
+        }
+    }
 
     if (argc == 5) {
-        std::ofstream fout;
-        fout.open(argv[4], std::ios_base::app);
-        fout << hdecay << '\n';
-        message(appname,
-                "the output has been saved to `" + std::string(argv[4]) + "'.");
+        const std::string fname{argv[4]};
+        const auto rec = mkRecord(mh, tan_beta, cos_alpha_beta, hdecay);
+        if (fchiggs::isResultFile(fname)) {
+            if (!fchiggs::appendRecord(fname, rec)) {
+                message(appname, "failed to write to `" + fname + "'.");
+                return 1;
+            }
+        } else {
+            std::ofstream fout;
+            fout.open(fname, std::ios_base::app);
+            fchiggs::writeText(fout, rec);
+        }
+        message(appname, "the output has been saved to `" + fname + "'.");
     }
 }
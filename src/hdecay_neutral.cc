@@ -9,30 +9,166 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <istream>
+#include <sstream>
 #include <string>
+#include "alpha_s.h"
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
+#include "dual.h"
 #include "gamma_h_neutral.h"
-#include "pdf.h"
+#include "results.h"
 #include "user_interface.h"
 
 using std::to_string;
 
 constexpr char appname[] = "hdecay_neutral";
 
-constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
 constexpr double MHSM = 125.0;
 constexpr double MZP = 400.0;
 constexpr double GZPX = 0.01;
 constexpr double MU = 200.0;
 constexpr double VS = 1000.0;
-const double Y33U = SQRT2 * MT / VEW;
+
+/** the BRs and their derivatives w.r.t. (tan(beta), cos(alpha-beta)). */
+void printGradient(const double mh, const double alpha_s,
+                   const double tan_beta, const double cos_alpha_beta) {
+    using fchiggs::Grad;
+    const fchiggs::BasicAngles<Grad> ang{Grad{tan_beta, 0},
+                                         Grad{cos_alpha_beta, 1}};
+    const fchiggs::BasicHup<Grad> cup{ang, Y33U};
+    const fchiggs::BasicHdown<Grad> cdown{ang};
+    const fchiggs::BasicHQuartic<Grad> lambda_h{
+        MHSM, mh, fchiggs::Mu(MU), fchiggs::Vs(VS), ang};
+    const fchiggs::BasicHiggsDecayWidth<Grad> hdecay{
+        mh,
+        MHSM,
+        MZP,
+        alpha_s,
+        fchiggs::GZPX(GZPX),
+        fchiggs::ValueType<Grad>(lambda_h.trilinear()),
+        cup,
+        cdown,
+        ang};
+    hdecay.printBR();
+}
+
+/** the parameters of a point. Those after cos(alpha-beta) are optional. */
+struct Point {
+    double mh, tan_beta, cos_alpha_beta;
+    double mzp = MZP, gzpx = GZPX, mu = MU, vs = VS;
+};
+
+fchiggs::HiggsDecayWidth mkDecayWidth(const Point &p) {
+    const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+    fchiggs::HQuartic lambda_h{MHSM, p.mh, fchiggs::Mu(p.mu),
+                               fchiggs::Vs(p.vs), ang};
+    return {p.mh,
+            MHSM,
+            p.mzp,
+            fchiggs::alphaS()(p.mh),
+            fchiggs::GZPX(p.gzpx),
+            fchiggs::GH3(lambda_h.trilinear()),
+            cup,
+            cdown,
+            ang};
+}
+
+/** the record of the point with its BRs. */
+fchiggs::Record mkRecord(const Point &p,
+                         const fchiggs::HiggsDecayWidth &hdecay) {
+    fchiggs::Record rec{fchiggs::Source::HdecayNeutral, p.mh, p.tan_beta,
+                        p.cos_alpha_beta};
+    rec.mzp = p.mzp;
+    rec.gzpx = p.gzpx;
+    rec.mu = p.mu;
+    rec.vs = p.vs;
+    rec.setBR(hdecay);
+    return rec;
+}
+
+/** reads all four of `m_Z' g_Z'X mu v_s' or none, with nothing after. */
+bool readExtras(std::istream &is, Point *p) {
+    Point extra = *p;
+    if (!(is >> std::ws).eof() &&
+        !(is >> extra.mzp >> extra.gzpx >> extra.mu >> extra.vs)) {
+        return false;
+    }
+    std::string rest;
+    if (is >> rest) { return false; }
+    *p = extra;
+    return true;
+}
+
+/**
+ *  Reads `m_H tan(beta) cos(alpha-beta) [m_Z' g_Z'X mu v_s]' per line and
+ *  writes the parameters and the BRs of each point as soon as it is
+ *  computed, in the order of the input. The empty lines and those starting
+ *  with `#' are skipped, and the other lines that cannot be read are
+ *  rejected.
+ */
+int batch(std::istream &is, const std::string &output) {
+    const bool binary = !output.empty() && fchiggs::isResultFile(output);
+    std::ofstream fout;
+    if (!output.empty() && !binary) {
+        fout.open(output, std::ios_base::app);
+    }
+    std::ostream &os = output.empty() ? std::cout : fout;
+
+    std::string line;
+    unsigned long nline = 0, npoint = 0;
+    while (std::getline(is, line)) {
+        ++nline;
+        std::istringstream ls{line};
+        Point p;
+        if (!(ls >> p.mh)) { continue; }  // empty or a comment
+        if (!(ls >> p.tan_beta >> p.cos_alpha_beta) || !readExtras(ls, &p)) {
+            std::cerr << appname << ": line " << nline << " is ignored.\n";
+            continue;
+        }
+
+        const auto rec = mkRecord(p, mkDecayWidth(p));
+        if (binary) {
+            if (!fchiggs::appendRecord(output, rec)) {
+                std::cerr << appname << ": failed to write to `" << output
+                          << "'.\n";
+                return 1;
+            }
+        } else {
+            fchiggs::writeText(os, rec, true);
+            os.flush();
+        }
+        ++npoint;
+    }
+    if (!output.empty()) {
+        message(appname, to_string(npoint) + " points have been saved to `" +
+                             output + "'.");
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
+    if (argc == 2 || argc == 3) {
+        const std::string input{argv[1]};
+        const std::string output{argc == 3 ? argv[2] : ""};
+        if (input == "-") { return batch(std::cin, output); }
+        std::ifstream fin{input};
+        if (!fin) {
+            std::cerr << appname << ": cannot read `" << input << "'.\n";
+            return 1;
+        }
+        return batch(fin, output);
+    }
     if (argc < 4 || argc > 5) {
         std::cerr << "Usage: " << appname
-                  << "<m_H (GeV>) <tan(beta)> <cos(alpha-beta)> [output]\n";
+                  << " <m_H (GeV)> <tan(beta)> <cos(alpha-beta)> [output]\n"
+                  << "       " << appname << " <points> [output]\n"
+                  << "  points: a file of `m_H tan(beta) cos(alpha-beta)"
+                     " [m_Z' g_Z'X mu v_s]'\n"
+                  << "          per line, or `-' for stdin\n";
         return 1;
     }
 
@@ -45,28 +181,33 @@ int main(int argc, char *argv[]) {
     const double cos_alpha_beta = std::atof(argv[3]);
     message(appname, "tan(beta) = " + to_string(tan_beta) +
                          ", cos(alpha-beta) = " + to_string(cos_alpha_beta));
-    fchiggs::Angles ang{tan_beta, cos_alpha_beta};
-    const fchiggs::Hup cup{ang, Y33U};
-    const fchiggs::Hdown cdown{ang};
-
-    auto pdf = fchiggs::mkPdf(PDFNAME);
-    const double alpha_s = pdf->alphasQ(mh);
+    const double alpha_s = fchiggs::alphaS()(mh);
     message(appname, "alpha_s(m_H) = " + to_string(alpha_s));
 
-    fchiggs::HQuartic lambda_h{MHSM, mh, fchiggs::Mu(MU), fchiggs::Vs(VS), ang};
-    const double ghhh = lambda_h.trilinear();
-
-    fchiggs::HiggsDecayWidth hdecay{
-        mh,  MHSM,  MZP, alpha_s, fchiggs::GZPX(GZPX), fchiggs::GH3(ghhh),
-        cup, cdown, ang};
+    const Point p{mh, tan_beta, cos_alpha_beta};
+    const auto hdecay = mkDecayWidth(p);
 
-    if (argc == 4) { hdecay.printBR(); }
+    if (argc == 4) {
+        if (std::getenv("FCHIGGS_GRADIENT")) {
+            printGradient(mh, alpha_s, tan_beta, cos_alpha_beta);
+        } else {
+            hdecay.printBR();
+        }
+    }
 
     if (argc == 5) {
-        std::ofstream fout;
-        fout.open(argv[4], std::ios_base::app);
-        fout << hdecay << '\n';
-        message(appname,
-                "the output has been saved to `" + std::string(argv[4]) + "'.");
+        const std::string fname{argv[4]};
+        const auto rec = mkRecord(p, hdecay);
+        if (fchiggs::isResultFile(fname)) {
+            if (!fchiggs::appendRecord(fname, rec)) {
+                message(appname, "failed to write to `" + fname + "'.");
+                return 1;
+            }
+        } else {
+            std::ofstream fout;
+            fout.open(fname, std::ios_base::app);
+            fchiggs::writeText(fout, rec);
+        }
+        message(appname, "the output has been saved to `" + fname + "'.");
     }
 }
@@ -11,11 +11,14 @@
 #include "utils.h"
 
 namespace fchiggs {
-void InitPartons::init(const double s) {
-    const double y = (2 * getRandom() - 1.0) * ymax_;
+InitPartons::InitPartons(const double s, const double shat)
+    : InitPartons(s, shat, getRandom()) {}
+
+void InitPartons::init(const double s, const double u) {
+    y_ = (2 * u - 1.0) * ymax_;
     const double sqrt_tau = std::sqrt(shat_ / s);
-    x1_ = sqrt_tau * std::exp(y);
-    x2_ = sqrt_tau * std::exp(-y);
+    x1_ = sqrt_tau * std::exp(y_);
+    x2_ = sqrt_tau * std::exp(-y_);
 }
 
 void Rho::init(const double qmin2, const double qmax2) {
@@ -37,7 +40,9 @@ double Rho::shat(const double val) const {
     return m_ * gamma_ * std::tan(val) + m_ * m_;
 }
 
-double rhoValue(const Rho &rho) {
-    return rho.rho1_ + getRandom() * (rho.rho2_ - rho.rho1_);
+double rhoValue(const Rho &rho) { return rhoValue(rho, getRandom()); }
+
+double rhoValue(const Rho &rho, const double u) {
+    return rho.rho1_ + u * (rho.rho2_ - rho.rho1_);
 }
 }  // namespace fchiggs
@@ -16,22 +16,27 @@ class InitPartons {
 private:
     double shat_;
     double ymax_;
+    double y_;
     double x1_, x2_;
 
 public:
     InitPartons() = delete;
-    InitPartons(const double s, const double shat)
+    InitPartons(const double s, const double shat);
+    /** the rapidity is given by the uniform variate u in [0, 1). */
+    InitPartons(const double s, const double shat, const double u)
         : shat_{shat}, ymax_{-0.5 * std::log(shat_ / s)} {
-        init(s);
+        init(s, u);
     }
 
     double x1() const { return x1_; }
     double x2() const { return x2_; }
     double shat() const { return shat_; }
+    /** the rapidity of the partonic CM frame. */
+    double y() const { return y_; }
     double delta_y() const { return 2 * ymax_; }
 
 private:
-    void init(const double s);
+    void init(const double s, const double u);
 };
 
 class Rho {
@@ -54,13 +59,16 @@ public:
     /** \hat{s} = M * Gamma * tan(rho) + M^2 */
     double shat(const double val) const;
 
-    friend double rhoValue(const Rho &rho);
+    friend double rhoValue(const Rho &rho, const double u);
 
 private:
     void init(const double qmin2, const double qmax2);
 };
 
 double rhoValue(const Rho &rho);
+
+/** rho of the uniform variate u in [0, 1). */
+double rhoValue(const Rho &rho, const double u);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_INITIAL_STATES_H_
@@ -0,0 +1,275 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "joint.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "alloc_guard.h"
+#include "constants.h"
+#include "initial_states.h"
+#include "qmc.h"
+#include "strata.h"
+#include "telemetry.h"
+#include "utils.h"
+
+namespace fchiggs {
+namespace {
+MultiChannel mergeChannels(const std::vector<Production> &prods) {
+    std::vector<MultiChannel> mcs;
+    for (const auto &prod : prods) { mcs.push_back(prod.channels()); }
+    return merge(mcs);
+}
+}  // namespace
+
+JointProduction::JointProduction(const std::vector<Production> &prods)
+    : prods_(prods),
+      pdf_(prods.empty() ? nullptr : prods.front().pdf()),
+      s_(prods.empty() ? 0 : prods.front().s()),
+      mu_(prods.empty() ? 0 : prods.front().mu()),
+      channels_(mergeChannels(prods)) {
+    if (prods_.empty()) {
+        throw std::invalid_argument("no production to integrate");
+    }
+    for (const auto &prod : prods_) {
+        if (prod.pdf() != pdf_ || prod.s() != s_ || prod.mu() != mu_) {
+            throw std::invalid_argument(
+                "the productions differ in the PDF, sqrt(s) or scale");
+        }
+    }
+}
+
+void JointProduction::weights(const Uniforms &u, double *w) const {
+    const double shat = channels_.shat(u.rho);
+    const double g = channels_.density(shat);
+    if (g <= 0) {
+        std::fill(w, w + prods_.size(), 0.0);
+        Telemetry::record(0);
+        return;
+    }
+    weights(shat, g, u.y, w);
+    Telemetry::record(w[0]);
+}
+
+void JointProduction::weights(const double shat, const double g,
+                              const double uy, double *w) const {
+    const InitPartons p{s_, shat, uy};
+    const PartonPoint pdf{*pdf_, p.x1(), p.x2(), mu_};
+    for (std::size_t i = 0; i != prods_.size(); ++i) {
+        w[i] = prods_[i].dsigma(pdf, p) / (s_ * g);
+    }
+}
+
+void JointProduction::adaptChannels(const unsigned int n,
+                                    const unsigned int niter) {
+    if (channels_.size() < 2) { return; }
+
+    const std::size_t nchannel = channels_.size(), nprod = prods_.size();
+    std::vector<double> w(nprod), sum_w(nprod), acc(nchannel * nprod),
+        a(nchannel);
+    for (unsigned int iter = 0; iter != niter; ++iter) {
+        std::fill(sum_w.begin(), sum_w.end(), 0.0);
+        std::fill(acc.begin(), acc.end(), 0.0);
+        const AllocGuard guard{"JointProduction::adaptChannels"};
+        for (unsigned int itry = 0; itry != n; ++itry) {
+            const Uniforms u{getRandom(), getRandom()};
+            const double shat = channels_.shat(u.rho);
+            const double g = channels_.density(shat);
+            if (g <= 0) {
+                Telemetry::record(0);
+                continue;
+            }
+            weights(shat, g, u.y, w.data());
+            Telemetry::record(w[0]);
+            for (std::size_t j = 0; j != nprod; ++j) { sum_w[j] += w[j]; }
+            for (std::size_t i = 0; i != nchannel; ++i) {
+                const double r = channels_.density(i, shat) / g;
+                for (std::size_t j = 0; j != nprod; ++j) {
+                    acc[i * nprod + j] += r * w[j] * w[j];
+                }
+            }
+        }
+        // the weights relative to the mean of each production.
+        for (std::size_t i = 0; i != nchannel; ++i) {
+            a[i] = 0;
+            for (std::size_t j = 0; j != nprod; ++j) {
+                const double mean = sum_w[j] / n;
+                if (mean > 0) { a[i] += acc[i * nprod + j] / (mean * mean); }
+            }
+        }
+        channels_.adapt(a);
+    }
+}
+
+double JointXsec::correlation(const std::size_t i,
+                              const std::size_t j) const {
+    const double norm = sigma[i].second * sigma[j].second;
+    return norm > 0 ? covariance[i * size() + j] / norm : 0;
+}
+
+namespace {
+/**
+ *  The cross sections from the sums of the weights and their products.
+ *  The covariance of the weights is over n as in sigma, or over n - 1 as
+ *  in sigmaOfEstimates if they are a few independent estimates.
+ */
+JointXsec mkJointXsec(const std::vector<double> &sum_w,
+                      const std::vector<double> &sum_ww,
+                      const unsigned int n, const bool estimates) {
+    const std::size_t nprod = sum_w.size();
+    JointXsec result;
+    for (std::size_t j = 0; j != nprod; ++j) {
+        const double sum_sq = sum_ww[j * nprod + j];
+        result.sigma.push_back(estimates
+                                   ? sigmaOfEstimates(sum_w[j], sum_sq, n)
+                                   : sigma(sum_w[j], sum_sq, n));
+    }
+    const double dof = estimates ? n - 1.0 : n;
+    for (std::size_t j = 0; j != nprod; ++j) {
+        for (std::size_t k = 0; k != nprod; ++k) {
+            const double cov = (sum_ww[j * nprod + k] / n -
+                                sum_w[j] / n * (sum_w[k] / n)) / dof;
+            result.covariance.push_back(cov * PBCONV * PBCONV);
+        }
+    }
+    return result;
+}
+
+/** adds the products w[j] w[k] of the weights to sum_ww. */
+void addProducts(const double *w, const std::size_t nprod, double *sum_ww) {
+    for (std::size_t j = 0; j != nprod; ++j) {
+        for (std::size_t k = 0; k != nprod; ++k) {
+            sum_ww[j * nprod + k] += w[j] * w[k];
+        }
+    }
+}
+
+JointXsec xsec_joint(const JointProduction &joint, const unsigned int n) {
+    const std::size_t nprod = joint.size();
+    std::vector<double> w(nprod), sum_w(nprod), sum_ww(nprod * nprod);
+    {
+        const AllocGuard guard{"xsec_joint"};
+        for (unsigned int itry = 0; itry != n; ++itry) {
+            joint.weights({getRandom(), getRandom()}, w.data());
+            for (std::size_t j = 0; j != nprod; ++j) { sum_w[j] += w[j]; }
+            addProducts(w.data(), nprod, sum_ww.data());
+        }
+    }
+    return mkJointXsec(sum_w, sum_ww, n, false);
+}
+
+/** the covariance is that of the estimates of the randomizations. */
+JointXsec xsec_qmc_joint(const JointProduction &joint, const unsigned int n,
+                         const unsigned int nrand) {
+    const std::size_t nprod = joint.size();
+    Sobol sobol{joint.dim()};
+    double u[Sobol::MAXDIM] = {0.0};
+    std::vector<double> w(nprod), sum_w(nprod), estimate(nprod), sum(nprod),
+        sum_ee(nprod * nprod);
+    for (unsigned int irand = 0; irand != nrand; ++irand) {
+        sobol.randomize();
+        std::fill(sum_w.begin(), sum_w.end(), 0.0);
+        const AllocGuard guard{"xsec_qmc_joint"};
+        for (unsigned int ipt = 0; ipt != n; ++ipt) {
+            sobol.next(u);
+            joint.weights({u[0], u[1]}, w.data());
+            for (std::size_t j = 0; j != nprod; ++j) { sum_w[j] += w[j]; }
+        }
+        for (std::size_t j = 0; j != nprod; ++j) {
+            estimate[j] = sum_w[j] / n;
+            sum[j] += estimate[j];
+        }
+        addProducts(estimate.data(), nprod, sum_ee.data());
+    }
+    return mkJointXsec(sum, sum_ee, nrand, true);
+}
+
+/**
+ *  The strata are allocated by the variance of the first production. The
+ *  covariance is summed over the strata of each pass, and averaged over
+ *  the passes, as the variance in Strata.
+ */
+JointXsec xsec_stratified_joint(const JointProduction &joint,
+                                const unsigned int n,
+                                const unsigned int niter) {
+    const std::size_t nprod = joint.size();
+    std::vector<Strata> strata(nprod, Strata{joint.dim(), NSTRATABINS});
+    const std::size_t ncell = strata[0].size();
+    const double vol = 1.0 / ncell;
+    // the sums of the weights and their products in each stratum in a pass.
+    std::vector<double> w(nprod), sum_w(ncell * nprod),
+        sum_ww(ncell * nprod * nprod);
+    std::vector<double> covariance(nprod * nprod);
+    double u[2] = {0.0};
+    for (unsigned int iter = 0; iter != niter; ++iter) {
+        const auto alloc = strata[0].allocate(n / niter);
+        std::fill(sum_w.begin(), sum_w.end(), 0.0);
+        std::fill(sum_ww.begin(), sum_ww.end(), 0.0);
+        const AllocGuard guard{"xsec_stratified_joint"};
+        for (std::size_t i = 0; i != ncell; ++i) {
+            for (unsigned long k = 0; k != alloc[i]; ++k) {
+                strata[0].point(i, u);
+                joint.weights({u[0], u[1]}, w.data());
+                for (std::size_t j = 0; j != nprod; ++j) {
+                    strata[j].add(i, w[j]);
+                    sum_w[i * nprod + j] += w[j];
+                }
+                addProducts(w.data(), nprod, &sum_ww[i * nprod * nprod]);
+            }
+
+            const double m = alloc[i];
+            if (m < 2) { continue; }
+            const double *cell_w = &sum_w[i * nprod];
+            const double *cell_ww = &sum_ww[i * nprod * nprod];
+            for (std::size_t j = 0; j != nprod; ++j) {
+                for (std::size_t k = 0; k != nprod; ++k) {
+                    const double cov = (cell_ww[j * nprod + k] / m -
+                                        cell_w[j] / m * (cell_w[k] / m)) /
+                                       (m - 1);
+                    covariance[j * nprod + k] += vol * vol * cov;
+                }
+            }
+        }
+        for (auto &st : strata) { st.endPass(); }
+    }
+
+    JointXsec result;
+    for (const auto &st : strata) {
+        const auto r = st.estimate();
+        result.sigma.emplace_back(r.first * PBCONV, r.second * PBCONV);
+    }
+    const double conv = PBCONV / niter;
+    for (const double cov : covariance) {
+        result.covariance.push_back(cov * conv * conv);
+    }
+    return result;
+}
+}  // namespace
+
+JointXsec integrate_joint(const JointProduction &joint, const unsigned int n,
+                          const Method &method, std::ostream *diag) {
+    JointProduction tuned{joint};
+    unsigned int nevent = n;
+    if (tuned.channels().size() > 1) {
+        const auto nwarmup = static_cast<unsigned int>(WARMUP * n);
+        tuned.adaptChannels(nwarmup / NWARMUPITER, NWARMUPITER);
+        nevent -= nwarmup;
+        if (diag) { tuned.channels().print(*diag); }
+    }
+
+    if (method == Method::QMC) {
+        return xsec_qmc_joint(tuned, nevent / NRAND, NRAND);
+    }
+    if (method == Method::Stratified) {
+        return xsec_stratified_joint(tuned, nevent, NSTRATAITER);
+    }
+    return xsec_joint(tuned, nevent);
+}
+}  // namespace fchiggs
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_JOINT_H_
+#define FCHIGGS_SRC_JOINT_H_
+
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "multichannel.h"
+#include "pdf.h"
+#include "xsec.h"
+
+namespace fchiggs {
+/**
+ *  Several productions integrated on the same events.
+ *
+ *  The productions must have the same m_H, sqrt(s) and PDF, and so the
+ *  same scale. Then a point (\hat{s}, y) gives the same x1 and x2 in all of
+ *  them. \hat{s} is sampled from the union of their channels, which covers
+ *  the range of every process, and each process below its threshold just
+ *  gets zero weight. The densities at x1 and x2 are evaluated once per
+ *  point in a PartonPoint and shared by the processes.
+ *
+ *  This pays for the q g --> q' H processes, whose ranges of \hat{s}
+ *  overlap. p p --> H lives on a narrow peak below all their thresholds,
+ *  where they vanish, and is better integrated on its own.
+ */
+class JointProduction {
+private:
+    std::vector<Production> prods_;
+    std::shared_ptr<PartonDensity> pdf_;
+    double s_, mu_;
+    MultiChannel channels_;
+
+public:
+    JointProduction() = delete;
+    /** throws std::invalid_argument if the productions do not match. */
+    explicit JointProduction(const std::vector<Production> &prods);
+
+    std::size_t size() const { return prods_.size(); }
+    const Production &production(const std::size_t i) const {
+        return prods_[i];
+    }
+    const MultiChannel &channels() const { return channels_; }
+
+    /** the number of integration variables. */
+    unsigned int dim() const { return 2; }
+
+    /**
+     *  The weights of all the productions at the given point of the unit
+     *  hypercube in units of GeV^{-2}, written to w[0], ..., w[size() - 1].
+     */
+    void weights(const Uniforms &u, double *w) const;
+
+    /**
+     *  Tunes the weights of the \hat{s} channels with niter iterations of
+     *  n events to minimize the sum of the squared relative errors of the
+     *  productions.
+     */
+    void adaptChannels(const unsigned int n, const unsigned int niter);
+
+private:
+    /** the weights at \hat{s} of the density g and the variate of y. */
+    void weights(const double shat, const double g, const double uy,
+                 double *w) const;
+};
+
+/** the cross sections of the productions on the same events. */
+struct JointXsec {
+    /** the cross section of each production and its error in pb. */
+    std::vector<std::pair<double, double>> sigma;
+    /**
+     *  The covariance of the cross sections in pb^2, size() x size() in row
+     *  major order. Its diagonal holds the squared errors.
+     */
+    std::vector<double> covariance;
+
+    std::size_t size() const { return sigma.size(); }
+    double correlation(const std::size_t i, const std::size_t j) const;
+};
+
+/**
+ *  The cross section of each production and its error in pb from the same
+ *  n events, with the channels tuned and the method as in integrate. The
+ *  errors are thus correlated, as given by the covariance. The strata of
+ *  Method::Stratified are allocated by the variance of the first
+ *  production.
+ */
+JointXsec integrate_joint(const JointProduction &joint, const unsigned int n,
+                          const Method &method, std::ostream *diag = nullptr);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_JOINT_H_
@@ -76,13 +76,16 @@ private:
 public:
     CM22() = delete;
     CM22(const double s, const double mh, const double mqin, const double mqout)
+        : CM22(s, mh, mqin, mqout, costh(DELTA), TWOPI * getRandom()) {}
+    CM22(const double s, const double mh, const double mqin, const double mqout,
+         const double cth, const double phi)
         : s_(s),
           mh2_(mh * mh),
           mqin2_(mqin * mqin),
           mqout2_(mqout * mqout),
-          costh_(costh(DELTA)),
+          costh_(cth),
           sinth_(std::sqrt(1.0 - costh_ * costh_)),
-          phi_(TWOPI * getRandom()) {
+          phi_(phi) {
         init();
     }
 
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "multichannel.h"
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+namespace fchiggs {
+void ShatChannel::init() {
+    if (type_ == Mapping::BreitWigner) {
+        const double mgamma = p1_ * p2_, m2 = p1_ * p1_;
+        lo_ = std::atan((smin_ - m2) / mgamma);
+        hi_ = std::atan((smax_ - m2) / mgamma);
+    } else if (type_ == Mapping::PowerLaw) {
+        if (p1_ == 1.0) {
+            lo_ = std::log(smin_);
+            hi_ = std::log(smax_);
+        } else {
+            lo_ = std::pow(smin_, 1.0 - p1_);
+            hi_ = std::pow(smax_, 1.0 - p1_);
+        }
+    } else {
+        lo_ = std::log(p1_);
+        hi_ = std::log(smax_ - smin_ + p1_);
+    }
+}
+
+double ShatChannel::shat(const double u) const {
+    const double v = lo_ + u * (hi_ - lo_);
+    if (type_ == Mapping::BreitWigner) {
+        return p1_ * p2_ * std::tan(v) + p1_ * p1_;
+    } else if (type_ == Mapping::PowerLaw) {
+        return p1_ == 1.0 ? std::exp(v) : std::pow(v, 1.0 / (1.0 - p1_));
+    }
+    return smin_ + std::exp(v) - p1_;
+}
+
+double ShatChannel::density(const double shat) const {
+    if (shat < smin_ || shat > smax_) { return 0; }
+
+    if (type_ == Mapping::BreitWigner) {
+        const double mgamma = p1_ * p2_, ds = shat - p1_ * p1_;
+        return mgamma / ((ds * ds + mgamma * mgamma) * (hi_ - lo_));
+    } else if (type_ == Mapping::PowerLaw) {
+        if (p1_ == 1.0) { return 1.0 / (shat * (hi_ - lo_)); }
+        return (1.0 - p1_) * std::pow(shat, -p1_) / (hi_ - lo_);
+    }
+    return 1.0 / ((shat - smin_ + p1_) * (hi_ - lo_));
+}
+
+double MultiChannel::shat(const double u) const {
+    double cumulative = 0;
+    for (std::size_t i = 0; i + 1 < channels_.size(); ++i) {
+        if (u < cumulative + alpha_[i]) {
+            return channels_[i].shat((u - cumulative) / alpha_[i]);
+        }
+        cumulative += alpha_[i];
+    }
+    const double last = alpha_.back();
+    const double v = std::min(std::max((u - cumulative) / last, 0.0), 1.0);
+    return channels_.back().shat(v);
+}
+
+double MultiChannel::density(const double shat) const {
+    double g = 0;
+    for (std::size_t i = 0; i != channels_.size(); ++i) {
+        g += alpha_[i] * channels_[i].density(shat);
+    }
+    return g;
+}
+
+void MultiChannel::adapt(const std::vector<double> &w) {
+    // keep every channel alive with a small weight.
+    const double alpha_min = 0.01 / channels_.size();
+    std::vector<double> alpha(alpha_.size());
+    double sum = 0;
+    for (std::size_t i = 0; i != alpha.size(); ++i) {
+        alpha[i] = alpha_[i] * std::sqrt(std::max(w[i], 0.0));
+        sum += alpha[i];
+    }
+    // without any weight, as when every event is cut away, there is
+    // nothing to learn.
+    if (!(sum > 0)) { return; }
+
+    double norm = 0;
+    for (auto &a : alpha) {
+        a = std::max(a / sum, alpha_min);
+        norm += a;
+    }
+    for (std::size_t i = 0; i != alpha.size(); ++i) {
+        alpha_[i] = alpha[i] / norm;
+    }
+}
+
+MultiChannel merge(const std::vector<MultiChannel> &mcs) {
+    std::vector<ShatChannel> channels;
+    for (const auto &mc : mcs) {
+        for (const auto &ch : mc.channels_) {
+            if (std::find(channels.begin(), channels.end(), ch) ==
+                channels.end()) {
+                channels.push_back(ch);
+            }
+        }
+    }
+    return MultiChannel{channels};
+}
+
+void MultiChannel::print(std::ostream &os) const {
+    const char *names[] = {"Breit-Wigner", "power law", "threshold log"};
+    os << "# channel, parameter (M, nu or c), alpha\n";
+    for (std::size_t i = 0; i != channels_.size(); ++i) {
+        os << names[static_cast<int>(channels_[i].type())] << '\t'
+           << channels_[i].parameter() << '\t' << alpha_[i] << '\n';
+    }
+}
+}  // namespace fchiggs
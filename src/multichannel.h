@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_MULTICHANNEL_H_
+#define FCHIGGS_SRC_MULTICHANNEL_H_
+
+#include <ostream>
+#include <vector>
+
+namespace fchiggs {
+/**
+ *  The mappings of a uniform variate onto \hat{s} in [smin, smax].
+ *
+ *  BreitWigner:  \hat{s} = M * Gamma * tan(rho) + M^2, uniform in rho
+ *                (as in Rho)
+ *  PowerLaw:     the density is proportional to 1 / \hat{s}^nu
+ *  ThresholdLog: uniform in log(\hat{s} - smin + c)
+ */
+enum class Mapping { BreitWigner, PowerLaw, ThresholdLog };
+
+class ShatChannel {
+private:
+    Mapping type_;
+    double smin_, smax_;
+    double p1_, p2_;  // (M, Gamma), (nu, -) or (c, -)
+    double lo_, hi_;  // the range of the mapped variable
+
+public:
+    ShatChannel() = delete;
+    ShatChannel(const Mapping type, const double smin, const double smax,
+                const double p1, const double p2 = 0)
+        : type_{type}, smin_{smin}, smax_{smax}, p1_{p1}, p2_{p2} {
+        init();
+    }
+
+    Mapping type() const { return type_; }
+    /** M, nu or c. */
+    double parameter() const { return p1_; }
+
+    /** \hat{s} of the uniform variate u in [0, 1). */
+    double shat(const double u) const;
+
+    /** the probability density of \hat{s}. */
+    double density(const double shat) const;
+
+    bool operator==(const ShatChannel &other) const {
+        return type_ == other.type_ && smin_ == other.smin_ &&
+               smax_ == other.smax_ && p1_ == other.p1_ && p2_ == other.p2_;
+    }
+
+private:
+    void init();
+};
+
+/**
+ *  A weighted sum of the \hat{s} mappings. Each event is generated from
+ *  one channel chosen with the probability alpha_i, and it is weighted by
+ *  the combined density sum_i alpha_i g_i(\hat{s}).
+ */
+class MultiChannel {
+private:
+    std::vector<ShatChannel> channels_;
+    std::vector<double> alpha_;
+
+public:
+    MultiChannel() = delete;
+    explicit MultiChannel(const std::vector<ShatChannel> &channels)
+        : channels_(channels), alpha_(channels.size(), 1.0 / channels.size()) {}
+
+    std::size_t size() const { return channels_.size(); }
+    double alpha(const std::size_t i) const { return alpha_[i]; }
+
+    /**
+     *  \hat{s} of the uniform variate u in [0, 1). u selects the channel
+     *  and is then rescaled to sample inside it.
+     */
+    double shat(const double u) const;
+
+    double density(const double shat) const;
+    double density(const std::size_t i, const double shat) const {
+        return channels_[i].density(shat);
+    }
+
+    /**
+     *  Updates the channel weights from w_i = < g_i / g * weight^2 >
+     *  (R. Kleiss and R. Pittau, Comput. Phys. Commun. 83, 141 (1994)).
+     *  The weights are kept as they are if every w_i is zero.
+     */
+    void adapt(const std::vector<double> &w);
+
+    void print(std::ostream &os) const;
+
+    friend MultiChannel merge(const std::vector<MultiChannel> &mcs);
+};
+
+/**
+ *  The channels of all the given, each distinct channel once, with equal
+ *  weights. Its density covers the ranges of \hat{s} of all of them.
+ */
+MultiChannel merge(const std::vector<MultiChannel> &mcs);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_MULTICHANNEL_H_
@@ -7,28 +7,115 @@
  */
 
 #include "pdf.h"
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "LHAPDF/AlphaS.h"
 #include "LHAPDF/Info.h"
 #include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/Paths.h"
 #include "constants.h"
+#include "pdf_grid.h"
 
 namespace fchiggs {
-std::shared_ptr<LHAPDF::PDF> mkPdf(const std::string &pdfname) {
+namespace {
+/** the configuration of LHAPDF is global, and so are the grids. */
+std::mutex &pdfMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::shared_ptr<PartonDensity> newLhapdf(const std::string &pdfname) {
     LHAPDF::Info &cfg{LHAPDF::getConfig()};
     cfg.set_entry("Verbosity", 0);  // make lhapdf quiet
     std::vector<int> flavors = {-5, -4, -3, -2, -1, 1, 2, 3, 4, 5, 21};
     cfg.set_entry("Flavors", flavors);
 
-    LHAPDF::AlphaS *alphas{new LHAPDF::AlphaS_ODE()};
+    LHAPDF::PDF *pdf{LHAPDF::mkPDF(pdfname)};
+    pdf->setAlphaS(mkLhapdfAlphaS().release());
+    return std::make_shared<LhapdfDensity>(pdf);
+}
+
+/** the member of `set/member', or 0 for `set'. */
+int memberOf(const std::string &pdfname) {
+    const auto slash = pdfname.find('/');
+    if (slash == std::string::npos) { return 0; }
+    const std::string digits = pdfname.substr(slash + 1);
+    char *end = nullptr;
+    errno = 0;
+    const long member = std::strtol(digits.c_str(), &end, 10);
+    if (digits.empty() || *end != '\0' || errno == ERANGE || member < 0 ||
+        member > std::numeric_limits<int>::max()) {
+        throw std::invalid_argument("invalid member of the PDF set `" +
+                                    pdfname + "'");
+    }
+    return static_cast<int>(member);
+}
+}  // namespace
+
+double PartonPoint::xfxQ(const int id, const double x,
+                         const double q) const {
+    const int slot = id == 21 || id == 0 ? 13 : id + 6;
+    if (q != q_ || slot < 0 || slot > 13) { return pdf_.xfxQ(id, x, q); }
+    if (x == x1_) {
+        if (!has1_[slot]) {
+            xf1_[slot] = pdf_.xfxQ(id, x, q);
+            has1_[slot] = true;
+        }
+        return xf1_[slot];
+    }
+    if (x == x2_) {
+        if (!has2_[slot]) {
+            xf2_[slot] = pdf_.xfxQ(id, x, q);
+            has2_[slot] = true;
+        }
+        return xf2_[slot];
+    }
+    return pdf_.xfxQ(id, x, q);
+}
+
+std::shared_ptr<PartonDensity> mkPdf(const std::string &pdfname) {
+    static std::map<std::string, std::weak_ptr<PartonDensity>> grids;
+    std::lock_guard<std::mutex> lock{pdfMutex()};
+
+    const std::string setname = pdfname.substr(0, pdfname.find('/'));
+    const int member = memberOf(pdfname);
+    const char *backend = std::getenv("FCHIGGS_PDF");
+    if (backend && std::string{backend} == "lhapdf") {
+        return newLhapdf(pdfname);
+    }
+
+    const std::string key = setname + '/' + std::to_string(member);
+    if (auto grid = grids[key].lock()) { return grid; }
+
+    const std::string fname = LHAPDF::findpdfmempath(setname, member);
+    if (fname.empty()) { return newLhapdf(pdfname); }
+    const char *shm = std::getenv("FCHIGGS_PDF_SHM");
+    std::shared_ptr<PartonDensity> grid =
+        shm && *shm ? sharedPdfGrid(shm, fname, setname, member)
+                    : std::make_shared<PdfGrid>(fname, setname, member);
+    grids[key] = grid;
+    return grid;
+}
+
+std::shared_ptr<PartonDensity> mkLhapdf(const std::string &pdfname) {
+    std::lock_guard<std::mutex> lock{pdfMutex()};
+    return newLhapdf(pdfname);
+}
+
+std::unique_ptr<LHAPDF::AlphaS> mkLhapdfAlphaS() {
+    std::unique_ptr<LHAPDF::AlphaS> alphas{new LHAPDF::AlphaS_ODE()};
+    alphas->setOrderQCD(4);
     alphas->setQuarkMass(5, MB);
     alphas->setQuarkMass(6, MT);
     alphas->setMZ(MZ);
     alphas->setAlphaSMZ(ALPHAS);
-    std::shared_ptr<LHAPDF::PDF> pdf{LHAPDF::mkPDF(pdfname)};
-    pdf->setAlphaS(alphas);
-    return pdf;
+    return alphas;
 }
 }  // namespace fchiggs
@@ -9,12 +9,104 @@
 #ifndef FCHIGGS_SRC_PDF_H_
 #define FCHIGGS_SRC_PDF_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include "LHAPDF/LHAPDF.h"
 
 namespace fchiggs {
-std::shared_ptr<LHAPDF::PDF> mkPdf(const std::string &pdfname);
+/** the parton densities of a member of a PDF set. */
+class PartonDensity {
+public:
+    virtual ~PartonDensity() {}
+
+    /** x f(x, Q) of the parton of the PDG id. 0 is the gluon as 21. */
+    virtual double xfxQ(const int id, const double x, const double q) const = 0;
+
+    virtual std::string setName() const = 0;
+    virtual int member() const = 0;
+
+    /** the code that interpolates the grid, `fchiggs' or `lhapdf'. */
+    virtual std::string backend() const = 0;
+
+    /** whether the instance may be used by several threads at once. */
+    virtual bool threadSafe() const = 0;
+};
+
+/**
+ *  LHAPDF::PDF itself. It keeps mutable caches, so an instance must not be
+ *  shared between threads.
+ */
+class LhapdfDensity : public PartonDensity {
+private:
+    std::unique_ptr<LHAPDF::PDF> pdf_;
+
+public:
+    LhapdfDensity() = delete;
+    explicit LhapdfDensity(LHAPDF::PDF *pdf) : pdf_{pdf} {}
+
+    double xfxQ(const int id, const double x, const double q) const override {
+        return pdf_->xfxQ(id, x, q);
+    }
+    std::string setName() const override { return pdf_->set().name(); }
+    int member() const override { return pdf_->memberID(); }
+    std::string backend() const override { return "lhapdf"; }
+    bool threadSafe() const override { return false; }
+};
+
+/**
+ *  The densities at the x1 and x2 of a partonic point, each flavor taken
+ *  from another PartonDensity when it is first asked for and then kept.
+ *  Several processes at the same point thus share a single evaluation of
+ *  every flavor. Any other x or Q is passed through. An instance is meant
+ *  to live on the stack of one thread for one point.
+ */
+class PartonPoint : public PartonDensity {
+private:
+    /** the slots of the PDG ids -6, ..., 6 and the gluon. */
+    static constexpr std::size_t NSLOT = 14;
+
+    const PartonDensity &pdf_;
+    double x1_, x2_, q_;
+    mutable std::array<double, NSLOT> xf1_, xf2_;
+    mutable std::array<bool, NSLOT> has1_, has2_;
+
+public:
+    PartonPoint() = delete;
+    PartonPoint(const PartonDensity &pdf, const double x1, const double x2,
+                const double q)
+        : pdf_{pdf}, x1_{x1}, x2_{x2}, q_{q}, has1_{}, has2_{} {}
+
+    double xfxQ(const int id, const double x, const double q) const override;
+    std::string setName() const override { return pdf_.setName(); }
+    int member() const override { return pdf_.member(); }
+    std::string backend() const override { return pdf_.backend(); }
+    bool threadSafe() const override { return false; }
+};
+
+/**
+ *  The PDF set of the given name (`set' or `set/member'). If the grid file
+ *  of the member is found, it is loaded once into a PdfGrid shared by all
+ *  the callers and threads. Otherwise, or if the environment variable
+ *  FCHIGGS_PDF is `lhapdf', a new LhapdfDensity with alpha_s from
+ *  constants.h is made. If FCHIGGS_PDF_SHM is set to a directory, such as
+ *  /dev/shm, the grid is shared by the jobs of the node with
+ *  sharedPdfGrid. It is safe to call this from several threads. Throws
+ *  std::invalid_argument if the member is not a number.
+ */
+std::shared_ptr<PartonDensity> mkPdf(const std::string &pdfname);
+
+/**
+ *  A new LhapdfDensity of the PDF set (`set' or `set/member') with alpha_s
+ *  from constants.h, whatever FCHIGGS_PDF says.
+ */
+std::shared_ptr<PartonDensity> mkLhapdf(const std::string &pdfname);
+
+/**
+ *  LHAPDF::AlphaS_ODE at four loops with the parameters in constants.h, as
+ *  given to the LhapdfDensity. alphaS() should agree with it.
+ */
+std::unique_ptr<LHAPDF::AlphaS> mkLhapdfAlphaS();
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_PDF_H_
@@ -0,0 +1,511 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "pdf_grid.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "temp_file.h"
+
+namespace fchiggs {
+namespace {
+int slot(const int id) {
+    if (id == 0 || id == 21) { return 13; }
+    if (id == 22) { return 14; }
+    if (id >= -6 && id <= 6) { return id + 6; }
+    return -1;
+}
+
+/**
+ *  The four knots around a point and their weights in the cubic Hermite
+ *  interpolation, with the slopes at the knots from finite differences.
+ *  The knots outside the grid have zero weights.
+ */
+struct Stencil {
+    double at;
+    std::size_t sub;
+    std::size_t idx[4];
+    double w[4];
+};
+
+Stencil stencil(const double *knots, const std::size_t n, const double at,
+                const std::size_t sub) {
+    Stencil s{at, sub, {0, 0, 0, 0}, {0, 0, 0, 0}};
+    const double v = std::min(std::max(at, knots[0]), knots[n - 1]);
+    std::size_t j = std::upper_bound(knots, knots + n, v) - knots;
+    j = std::min(std::max(j, std::size_t{1}), n - 1) - 1;
+
+    const double h = knots[j + 1] - knots[j], t = (v - knots[j]) / h;
+    const double t2 = t * t, t3 = t2 * t;
+    const double a = (t3 - 2 * t2 + t) * h, b = (t3 - t2) * h;
+    // the weights of the knots j - 1, j, j + 1 and j + 2.
+    double w[4] = {0, 2 * t3 - 3 * t2 + 1, -2 * t3 + 3 * t2, 0};
+    if (j == 0) {
+        w[1] -= a / h;
+        w[2] += a / h;
+    } else {
+        const double hm = knots[j] - knots[j - 1];
+        w[0] -= 0.5 * a / hm;
+        w[1] += 0.5 * a / hm - 0.5 * a / h;
+        w[2] += 0.5 * a / h;
+    }
+    if (j + 2 == n) {
+        w[1] -= b / h;
+        w[2] += b / h;
+    } else {
+        const double hp = knots[j + 2] - knots[j + 1];
+        w[1] -= 0.5 * b / h;
+        w[2] += 0.5 * b / h - 0.5 * b / hp;
+        w[3] += 0.5 * b / hp;
+    }
+    for (std::size_t k = 0; k != 4; ++k) {
+        // the clipped knots have zero weights.
+        s.idx[k] = std::min(std::max(j + k, std::size_t{1}), n) - 1;
+        s.w[k] = w[k];
+    }
+    return s;
+}
+
+/**
+ *  The interpolation state of a thread. x1 and x2 alternate in the matrix
+ *  elements, so the last two stencils in x are kept.
+ */
+struct alignas(64) ThreadCache {
+    std::uint64_t grid = 0;
+    Stencil q, x[2];
+    unsigned int next = 0;
+};
+
+thread_local ThreadCache tcache;
+
+std::atomic<std::uint64_t> nextId{1};
+
+std::vector<double> readKnots(std::istream &is, const bool take_log) {
+    std::string line;
+    std::getline(is, line);
+    std::istringstream ls{line};
+    std::vector<double> knots;
+    double v;
+    while (ls >> v) { knots.push_back(take_log ? std::log(v) : v); }
+    return knots;
+}
+
+/** a subgrid as read from the file. */
+struct Table {
+    std::vector<double> logx, logq;
+    std::size_t nflavor;
+    std::array<int, PdfGrid::NSLOT> column;
+    std::vector<double> xf;
+};
+
+/** the size and the modification time of a file, or zeros. */
+struct Stamp {
+    std::uint64_t size, mtime;
+};
+
+Stamp fileStamp(const std::string &fname) {
+    struct stat sb;
+    if (::stat(fname.c_str(), &sb) != 0) { return {0, 0}; }
+    return {static_cast<std::uint64_t>(sb.st_size),
+            static_cast<std::uint64_t>(sb.st_mtim.tv_sec) * 1000000000ULL +
+                static_cast<std::uint64_t>(sb.st_mtim.tv_nsec)};
+}
+
+constexpr char MAGIC[8] = {'f', 'c', 'H', 'g', 'r', 'i', 'd', '\0'};
+
+/** the start of an image, followed by nsub subgrids. */
+struct ImageHeader {
+    char magic[8];
+    std::uint64_t version;
+    /** the size of the whole image in bytes. */
+    std::uint64_t nbytes;
+    /** of the grid file. */
+    Stamp source;
+    /** of the bytes after the header. */
+    std::uint64_t checksum;
+    std::uint64_t nsub;
+};
+
+/** a subgrid in an image, followed by logx, logq and xf. */
+struct ImageSubgrid {
+    std::uint64_t nx, nq, nflavor;
+    std::int32_t column[16];
+};
+
+static_assert(sizeof(ImageHeader) % sizeof(double) == 0 &&
+                  sizeof(ImageSubgrid) % sizeof(double) == 0,
+              "the values in an image must be aligned");
+static_assert(PdfGrid::NSLOT <= 16, "too many slots for an image");
+
+/** the 64-bit FNV-1a hash over the 64-bit words of n bytes. */
+std::uint64_t checksum(const unsigned char *p, const std::size_t n) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i + sizeof h <= n; i += sizeof h) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i, sizeof w);
+        h ^= w;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+std::size_t append(unsigned char *p, const std::size_t off,
+                   const std::vector<double> &v) {
+    std::memcpy(p + off, v.data(), v.size() * sizeof(double));
+    return off + v.size() * sizeof(double);
+}
+
+/** lays out the subgrids in an image of *nbytes. */
+std::shared_ptr<const unsigned char> mkImage(const std::vector<Table> &tables,
+                                             const Stamp &source,
+                                             std::size_t *nbytes) {
+    std::size_t n = sizeof(ImageHeader);
+    for (const auto &t : tables) {
+        n += sizeof(ImageSubgrid) +
+             (t.logx.size() + t.logq.size() + t.xf.size()) * sizeof(double);
+    }
+    // in doubles for the alignment.
+    auto buf = std::make_shared<std::vector<double>>(n / sizeof(double));
+    unsigned char *p = reinterpret_cast<unsigned char *>(buf->data());
+
+    std::size_t off = sizeof(ImageHeader);
+    for (const auto &t : tables) {
+        ImageSubgrid sub{t.logx.size(), t.logq.size(), t.nflavor, {}};
+        std::fill(std::begin(sub.column), std::end(sub.column), -1);
+        std::copy(t.column.begin(), t.column.end(), sub.column);
+        std::memcpy(p + off, &sub, sizeof sub);
+        off = append(p, off + sizeof sub, t.logx);
+        off = append(p, off, t.logq);
+        off = append(p, off, t.xf);
+    }
+
+    ImageHeader h;
+    std::memcpy(h.magic, MAGIC, sizeof MAGIC);
+    h.version = PdfGrid::IMAGE_VERSION;
+    h.nbytes = n;
+    h.source = source;
+    h.checksum = checksum(p + sizeof h, n - sizeof h);
+    h.nsub = tables.size();
+    std::memcpy(p, &h, sizeof h);
+    *nbytes = n;
+    return {buf, p};
+}
+
+bool validImage(const unsigned char *p, const std::size_t n,
+                const Stamp &source) {
+    ImageHeader h;
+    if (n < sizeof h) { return false; }
+    std::memcpy(&h, p, sizeof h);
+    return std::memcmp(h.magic, MAGIC, sizeof MAGIC) == 0 &&
+           h.version == PdfGrid::IMAGE_VERSION && h.nbytes == n &&
+           h.source.size == source.size && h.source.mtime == source.mtime &&
+           h.checksum == checksum(p + sizeof h, n - sizeof h);
+}
+
+/** the read-only mapping of the valid image at path, or nullptr. */
+std::shared_ptr<const unsigned char> mapImage(const std::string &path,
+                                              const Stamp &source,
+                                              std::size_t *nbytes) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return nullptr; }
+    struct stat sb;
+    void *p = MAP_FAILED;
+    if (::fstat(fd, &sb) == 0 && sb.st_size > 0) {
+        p = ::mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);  // the mapping stays
+    if (p == MAP_FAILED) { return nullptr; }
+
+    const std::size_t n = sb.st_size;
+    std::shared_ptr<const unsigned char> image{
+        static_cast<const unsigned char *>(p), [n](const unsigned char *q) {
+            ::munmap(const_cast<unsigned char *>(q), n);
+        }};
+    if (!validImage(image.get(), n, source)) { return nullptr; }
+    *nbytes = n;
+    return image;
+}
+
+/**
+ *  Removes the segments in dir starting with prefix: those of other
+ *  versions and an invalid one. The temporary files may be of live jobs
+ *  and are left to sweepTemporaries.
+ */
+void removeStale(const std::string &dir, const std::string &prefix) {
+    DIR *d = ::opendir(dir.c_str());
+    if (!d) { return; }
+    while (const dirent *e = ::readdir(d)) {
+        const std::string name{e->d_name};
+        if (name.compare(0, prefix.size(), prefix) == 0 &&
+            name.find(".tmp.") == std::string::npos) {
+            ::unlink((dir + '/' + name).c_str());
+        }
+    }
+    ::closedir(d);
+}
+
+/**
+ *  The descriptor of the lock file, locked exclusively, or -1. The holder
+ *  removes the file before it releases the lock, so a job that was
+ *  waiting on the removed file tries again with the new one.
+ */
+int lockFile(const std::string &lockname) {
+    for (;;) {
+        const int fd =
+            ::open(lockname.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW, 0644);
+        if (fd < 0) { return -1; }
+        struct stat held, current;
+        if (::flock(fd, LOCK_EX) != 0 || ::fstat(fd, &held) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        if (::stat(lockname.c_str(), &current) == 0 &&
+            current.st_dev == held.st_dev && current.st_ino == held.st_ino) {
+            return fd;
+        }
+        ::close(fd);
+    }
+}
+}  // namespace
+
+PdfGrid::PdfGrid(const std::string &fname, const std::string &setname,
+                 const int member)
+    : id_{nextId++}, setname_{setname}, member_{member}, nbytes_{0} {
+    std::ifstream fin{fname};
+    if (!fin) { throw std::runtime_error("cannot open `" + fname + "'"); }
+
+    // the header is up to the first separator.
+    std::string line;
+    bool lhagrid1 = false;
+    while (std::getline(fin, line) && line.compare(0, 3, "---") != 0) {
+        if (line.find("Format:") == 0) {
+            lhagrid1 = line.find("lhagrid1") != std::string::npos;
+        }
+    }
+    if (!lhagrid1) {
+        throw std::runtime_error("`" + fname + "' is not in lhagrid1");
+    }
+
+    std::vector<Table> tables;
+    while (fin.peek() != EOF) {
+        Table sub;
+        sub.logx = readKnots(fin, true);
+        sub.logq = readKnots(fin, true);
+        const auto ids = readKnots(fin, false);
+        if (sub.logx.size() < 2 || sub.logq.size() < 2 || ids.empty()) {
+            break;
+        }
+        sub.nflavor = ids.size();
+        sub.column.fill(-1);
+        for (std::size_t i = 0; i != ids.size(); ++i) {
+            const int s = slot(static_cast<int>(ids[i]));
+            if (s >= 0) { sub.column[s] = static_cast<int>(i); }
+        }
+
+        const std::size_t nval =
+            sub.logx.size() * sub.logq.size() * sub.nflavor;
+        sub.xf.resize(nval);
+        for (auto &v : sub.xf) {
+            if (!(fin >> v)) {
+                throw std::runtime_error("`" + fname + "' is truncated");
+            }
+        }
+        std::getline(fin, line);  // the rest of the last row
+        std::getline(fin, line);  // the separator
+        tables.push_back(std::move(sub));
+    }
+    if (tables.empty()) {
+        throw std::runtime_error("`" + fname + "' has no grid");
+    }
+    image_ = mkImage(tables, fileStamp(fname), &nbytes_);
+    index();
+}
+
+PdfGrid::PdfGrid(std::shared_ptr<const unsigned char> image,
+                 const std::size_t nbytes, const std::string &setname,
+                 const int member)
+    : id_{nextId++},
+      setname_{setname},
+      member_{member},
+      image_{std::move(image)},
+      nbytes_{nbytes} {
+    index();
+}
+
+void PdfGrid::index() {
+    const unsigned char *p = image_.get();
+    const std::string invalid = "invalid image of the PDF grid of `" +
+                                setname_ + '/' + std::to_string(member_) +
+                                "'";
+    ImageHeader h;
+    if (nbytes_ < sizeof h) { throw std::runtime_error(invalid); }
+    std::memcpy(&h, p, sizeof h);
+    if (std::memcmp(h.magic, MAGIC, sizeof MAGIC) != 0 ||
+        h.version != IMAGE_VERSION || h.nbytes != nbytes_ || h.nsub == 0) {
+        throw std::runtime_error(invalid);
+    }
+
+    const std::size_t maxval = nbytes_ / sizeof(double);
+    std::size_t off = sizeof h;
+    subgrids_.clear();
+    for (std::uint64_t i = 0; i != h.nsub; ++i) {
+        ImageSubgrid is;
+        if (off + sizeof is > nbytes_) { throw std::runtime_error(invalid); }
+        std::memcpy(&is, p + off, sizeof is);
+        off += sizeof is;
+        if (is.nx < 2 || is.nq < 2 || is.nflavor == 0 || is.nx > maxval ||
+            is.nq > maxval || is.nflavor > maxval ||
+            is.nx + is.nq + is.nx * is.nq * is.nflavor >
+                (nbytes_ - off) / sizeof(double)) {
+            throw std::runtime_error(invalid);
+        }
+
+        Subgrid sub;
+        sub.nx = is.nx;
+        sub.nq = is.nq;
+        sub.nflavor = is.nflavor;
+        std::copy(is.column, is.column + NSLOT, sub.column.begin());
+        sub.logx = reinterpret_cast<const double *>(p + off);
+        sub.logq = sub.logx + sub.nx;
+        sub.xf = sub.logq + sub.nq;
+        off += (sub.nx + sub.nq + sub.nx * sub.nq * sub.nflavor) *
+               sizeof(double);
+        subgrids_.push_back(sub);
+    }
+}
+
+std::size_t PdfGrid::subgrid(const double logq) const {
+    std::size_t i = 0;
+    while (i + 1 < subgrids_.size() &&
+           logq >= subgrids_[i].logq[subgrids_[i].nq - 1]) {
+        ++i;
+    }
+    return i;
+}
+
+double PdfGrid::xfxQ(const int id, const double x, const double q) const {
+    const int s = slot(id);
+    if (s < 0) { return 0; }
+
+    ThreadCache &c = tcache;
+    if (c.grid != id_ || q != c.q.at) {
+        const double logq = std::log(q);
+        const std::size_t isub = subgrid(logq);
+        if (c.grid != id_ || c.q.sub != isub) {
+            // the stencils in x belong to another grid.
+            c.x[0].at = c.x[1].at = std::numeric_limits<double>::quiet_NaN();
+        }
+        c.q = stencil(subgrids_[isub].logq, subgrids_[isub].nq, logq, isub);
+        c.q.at = q;
+        c.grid = id_;
+    }
+    const Subgrid &sub = subgrids_[c.q.sub];
+    const int col = sub.column[s];
+    if (col < 0) { return 0; }
+
+    const Stencil *sx;
+    if (x == c.x[0].at) {
+        sx = &c.x[0];
+    } else if (x == c.x[1].at) {
+        sx = &c.x[1];
+    } else {
+        Stencil &slot_x = c.x[c.next];
+        c.next ^= 1;
+        slot_x = stencil(sub.logx, sub.nx, std::log(x), c.q.sub);
+        slot_x.at = x;
+        sx = &slot_x;
+    }
+
+    const std::size_t nq = sub.nq;
+    double xf = 0;
+    for (std::size_t a = 0; a != 4; ++a) {
+        if (sx->w[a] == 0) { continue; }
+        const double *row = &sub.xf[sx->idx[a] * nq * sub.nflavor + col];
+        double v = 0;
+        for (std::size_t b = 0; b != 4; ++b) {
+            v += c.q.w[b] * row[c.q.idx[b] * sub.nflavor];
+        }
+        xf += sx->w[a] * v;
+    }
+    return xf;
+}
+
+std::size_t PdfGrid::size() const {
+    std::size_t bytes = 0;
+    for (const auto &sub : subgrids_) {
+        bytes += (sub.nx * sub.nq * sub.nflavor + sub.nx + sub.nq) *
+                 sizeof(double);
+    }
+    return bytes;
+}
+
+std::shared_ptr<PdfGrid> sharedPdfGrid(const std::string &dir,
+                                       const std::string &fname,
+                                       const std::string &setname,
+                                       const int member) {
+    const Stamp source = fileStamp(fname);
+    if (source.size == 0) {
+        throw std::runtime_error("cannot open `" + fname + "'");
+    }
+    const std::string name =
+        "fchiggs-pdf." + setname + '.' + std::to_string(member);
+    const std::string path =
+        dir + '/' + name + ".v" + std::to_string(PdfGrid::IMAGE_VERSION);
+    std::size_t nbytes = 0;
+    auto image = mapImage(path, source, &nbytes);
+
+    std::shared_ptr<PdfGrid> grid;
+    if (!image) {
+        // only one job of the node loads the file, while the others wait.
+        ::mkdir(dir.c_str(), 0755);
+        const std::string lockname = dir + '/' + name + ".lock";
+        const int lock = lockFile(lockname);
+        if (lock >= 0) {
+            image = mapImage(path, source, &nbytes);
+            if (!image) {
+                removeStale(dir, name + ".v");
+                grid = std::make_shared<PdfGrid>(fname, setname, member);
+                sweepTemporaries(dir, "fchiggs-pdf.");
+                if (writeFile(path, grid->image_.get(), grid->nbytes_,
+                              Placement::Replace)) {
+                    image = mapImage(path, source, &nbytes);
+                }
+            }
+            ::unlink(lockname.c_str());
+            ::close(lock);  // releases the lock
+        }
+    }
+    if (image) {
+        return std::shared_ptr<PdfGrid>{
+            new PdfGrid{std::move(image), nbytes, setname, member}};
+    }
+
+    std::cerr << "fchiggs: cannot share the PDF grid in `" << dir
+              << "'. It is loaded privately.\n";
+    if (!grid) { grid = std::make_shared<PdfGrid>(fname, setname, member); }
+    return grid;
+}
+}  // namespace fchiggs
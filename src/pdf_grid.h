@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_PDF_GRID_H_
+#define FCHIGGS_SRC_PDF_GRID_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pdf.h"
+
+namespace fchiggs {
+/**
+ *  The grid of a PDF member in the LHAPDF `lhagrid1' format, interpolated
+ *  by cubic Hermite splines in log(x) and log(Q) as the LogBicubic
+ *  interpolator of LHAPDF. Outside the grid, the value at the nearest edge
+ *  is taken.
+ *
+ *  The knots and the values are immutable after loading, so a single
+ *  instance serves any number of threads. The only mutable state is the
+ *  last x and Q bins with their interpolation weights, kept per thread in
+ *  a cache-line-aligned thread_local block of a few cache lines. The
+ *  flavors at the same x and Q, as asked for by the matrix elements, then
+ *  cost 16 multiply-adds each.
+ *
+ *  The knots and the values live in a single flat image, which is either
+ *  owned or a read-only mapping of a segment published by another job (see
+ *  sharedPdfGrid).
+ */
+class PdfGrid : public PartonDensity {
+public:
+    /** the slots of the PDG ids -6, ..., 6, 21 (and 0) and 22. */
+    static constexpr std::size_t NSLOT = 15;
+
+    /** the version of the layout of the image. */
+    static constexpr std::uint64_t IMAGE_VERSION = 1;
+
+    /** a range of Q between flavor thresholds, in the image. */
+    struct Subgrid {
+        const double *logx, *logq;
+        std::size_t nx, nq, nflavor;
+        /** the column of each slot, or -1 if the flavor is absent. */
+        std::array<int, NSLOT> column;
+        /** x f at [(ix * nq + iq) * nflavor + column]. */
+        const double *xf;
+    };
+
+private:
+    std::uint64_t id_;
+    std::string setname_;
+    int member_;
+    std::shared_ptr<const unsigned char> image_;
+    std::size_t nbytes_;
+    std::vector<Subgrid> subgrids_;
+
+public:
+    PdfGrid() = delete;
+    /** throws std::runtime_error if the file cannot be read. */
+    PdfGrid(const std::string &fname, const std::string &setname,
+            const int member);
+
+    double xfxQ(const int id, const double x, const double q) const override;
+    std::string setName() const override { return setname_; }
+    int member() const override { return member_; }
+    std::string backend() const override { return "fchiggs"; }
+    bool threadSafe() const override { return true; }
+
+    /** the memory of the values and the knots in bytes. */
+    std::size_t size() const;
+
+private:
+    /**
+     *  The grid in the image of nbytes, which is shared with the owner of
+     *  image. Throws std::runtime_error if it is not an image of the member
+     *  in IMAGE_VERSION.
+     */
+    PdfGrid(std::shared_ptr<const unsigned char> image,
+            const std::size_t nbytes, const std::string &setname,
+            const int member);
+
+    /** finds the subgrids in the image. */
+    void index();
+
+    std::size_t subgrid(const double logq) const;
+
+    friend std::shared_ptr<PdfGrid> sharedPdfGrid(const std::string &dir,
+                                                  const std::string &fname,
+                                                  const std::string &setname,
+                                                  const int member);
+};
+
+/**
+ *  The grid of the member attached read-only from a segment in dir, which
+ *  should be on a node-local tmpfs such as /dev/shm. The first job to ask
+ *  for it loads the file fname, publishes its image there and attaches to
+ *  it; the other jobs of the node just map the segment, so the grid is in
+ *  memory only once. The segment holds the layout version, the size and
+ *  the modification time of fname, and a checksum. A segment that does
+ *  not match them or of another version is removed and published again,
+ *  and the temporary files of jobs that are gone are removed whenever a
+ *  segment is published. If the segment cannot be published, the grid is
+ *  loaded privately as by PdfGrid.
+ */
+std::shared_ptr<PdfGrid> sharedPdfGrid(const std::string &dir,
+                                       const std::string &fname,
+                                       const std::string &setname,
+                                       const int member);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_PDF_GRID_H_
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "angles.h"
+#include "constants.h"
+#include "cuts.h"
+#include "joint.h"
+#include "pdf.h"
+#include "results.h"
+#include "telemetry.h"
+#include "user_interface.h"
+#include "utils.h"
+#include "xsec.h"
+
+using std::to_string;
+
+constexpr char appname[] = "pph_joint";
+
+constexpr double ECM = 14000.0;
+constexpr double SBEAM = ECM * ECM;
+constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
+/** the events of p p --> H and of the 2 --> 2 processes, as in pph_neutral. */
+constexpr unsigned int NH = 8500000;
+constexpr unsigned int N = 800000;
+
+struct Channel {
+    fchiggs::Process proc;
+    fchiggs::Source source;
+    const char *name;
+};
+
+const Channel CHANNELS[] = {
+    {fchiggs::Process::H, fchiggs::Source::PphNeutral, "p p --> H"},
+    {fchiggs::Process::Hb, fchiggs::Source::PphbNeutral, "p p --> H b"},
+    {fchiggs::Process::HtCharged, fchiggs::Source::PphtCharged,
+     "p p --> H^\\pm t"},
+    {fchiggs::Process::HbCharged, fchiggs::Source::PphbCharged,
+     "p p --> H^\\pm b"}};
+
+int main(int argc, char *argv[]) {
+    if (argc < 4 || argc > 5) {
+        std::cerr << "Usage: " << appname
+                  << " <m_H (GeV)> <tan(beta)> <cos(alpha-beta)> [output]\n";
+        return 1;
+    }
+    message(appname, "p p --> H, H b, H^\\pm t, H^\\pm b on the same events");
+
+    message(appname, "E_{CM} = " + to_string(ECM / 1000.0) + " TeV");
+    const double mh = std::atof(argv[1]);
+    message(appname, "m_H = " + to_string(mh) + " GeV");
+
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+
+    const double tan_beta = std::atof(argv[2]);
+    const double cos_alpha_beta = std::atof(argv[3]);
+    message(appname, "tan(beta) = " + to_string(tan_beta) +
+                         ", cos(alpha-beta) = " + to_string(cos_alpha_beta));
+    const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
+    const auto cuts = fchiggs::fiducialCuts();
+    if (cuts.active()) { message(appname, "cuts: " + cuts.str()); }
+    // p p --> H is always in double precision, as in pph_neutral.
+    const fchiggs::Production prod_h{fchiggs::Process::H, pdf, SBEAM,
+                                     mh, ang, cuts};
+    // the 2 --> 2 processes share the events.
+    std::vector<fchiggs::Production> prods;
+    for (const auto &ch : CHANNELS) {
+        if (ch.proc == fchiggs::Process::H) { continue; }
+        prods.emplace_back(ch.proc, pdf, SBEAM, mh, ang, cuts);
+    }
+    const fchiggs::JointProduction joint{prods};
+
+    const auto method = fchiggs::integrationMethod();
+    message(appname, "integrating for cross sections" +
+                         fchiggs::methodLabel(method) + " ...");
+    std::ofstream diag;
+    if (const char *fname = std::getenv("FCHIGGS_DIAGNOSTICS")) {
+        diag.open(fname);
+    }
+    std::vector<std::pair<double, double>> result;
+    fchiggs::JointXsec result_joint;
+    {
+        const fchiggs::Telemetry telemetry{appname, NH + N};
+        result_joint = fchiggs::integrate_joint(
+            joint, N, method, diag.is_open() ? &diag : nullptr);
+        result.push_back(fchiggs::integrate(prod_h, NH, method));
+    }
+    result.insert(result.end(), result_joint.sigma.begin(),
+                  result_joint.sigma.end());
+    message(appname, "... done.");
+    for (std::size_t i = 0; i != result.size(); ++i) {
+        message(appname, std::string{CHANNELS[i].name} + ": " +
+                             to_string(result[i].first) + " +- " +
+                             to_string(result[i].second) + " pb");
+    }
+    // the 2 --> 2 processes follow p p --> H in CHANNELS.
+    message(appname, "the covariance (pb^2) and the correlation of:");
+    for (std::size_t j = 0; j != result_joint.size(); ++j) {
+        for (std::size_t k = 0; k <= j; ++k) {
+            std::ostringstream os;
+            os << "  " << CHANNELS[j + 1].name << ", " << CHANNELS[k + 1].name
+               << ": " << std::scientific << std::setprecision(4)
+               << result_joint.covariance[j * result_joint.size() + k] << ", "
+               << std::fixed << result_joint.correlation(j, k);
+            message(appname, os.str());
+        }
+    }
+
+    if (argc == 5) {
+        const std::string fname{argv[4]};
+        if (fchiggs::isResultFile(fname)) {
+            for (std::size_t i = 0; i != result.size(); ++i) {
+                fchiggs::Record rec{CHANNELS[i].source, mh, tan_beta,
+                                    cos_alpha_beta};
+                rec.sigma = result[i].first;
+                rec.error = result[i].second;
+                rec.n = i == 0 ? NH : N;
+                rec.seed = fchiggs::randomSeed();
+                if (!fchiggs::appendRecord(fname, rec)) {
+                    message(appname, "failed to write to `" + fname + "'.");
+                    return 1;
+                }
+            }
+        } else {
+            std::ofstream fout;
+            fout.open(fname, std::ios_base::app);
+            fout << std::right << std::fixed << std::setw(7)
+                 << std::setprecision(2) << mh << std::setprecision(9);
+            for (const auto &r : result) {
+                fout << std::setw(14) << r.first << std::setw(14) << r.second;
+            }
+            fout << '\n';
+        }
+        message(appname, "the output has been saved to `" + fname + "'.");
+    }
+}
@@ -7,18 +7,23 @@
  */
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
 #include "angles.h"
+#include "cache.h"
 #include "constants.h"
-#include "initial_states.h"
+#include "cuts.h"
 #include "pdf.h"
-#include "sigma_pph.h"
+#include "results.h"
+#include "telemetry.h"
 #include "user_interface.h"
 #include "utils.h"
+#include "xsec.h"
 
 using std::to_string;
 
@@ -28,12 +33,6 @@ constexpr double ECM = 14000.0;
 constexpr double SBEAM = ECM * ECM;
 constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
 constexpr unsigned int N = 8500000;
-constexpr double KGG = 2.5;
-const double Y33U = SQRT2 * MT / VEW;
-
-double weight(const fchiggs::Rho &rho, const std::shared_ptr<LHAPDF::PDF> &pdf,
-              const double mh, const fchiggs::Hup &hu, const fchiggs::Hdown &hd,
-              const fchiggs::Angles &ang);
 
 int main(int argc, char *argv[]) {
     if (argc < 4 || argc > 5) {
@@ -46,9 +45,6 @@ int main(int argc, char *argv[]) {
     message(appname, "E_{CM} = " + to_string(ECM / 1000.0) + " TeV");
     const double mh = std::atof(argv[1]);
     message(appname, "m_H = " + to_string(mh) + " GeV");
-    const double qmin = mh / 2.0, qmax = std::sqrt(SBEAM), mtr = mh,
-                 gtr = mh / 2.0;
-    const fchiggs::Rho rho{qmin, qmax, mtr, gtr, SBEAM};
 
     auto pdf = fchiggs::mkPdf(PDFNAME);
 
@@ -57,46 +53,74 @@ int main(int argc, char *argv[]) {
     message(appname, "tan(beta) = " + to_string(tan_beta) +
                          ", cos(alpha-beta) = " + to_string(cos_alpha_beta));
     const fchiggs::Angles ang{tan_beta, cos_alpha_beta};
-    const fchiggs::Hup hu{ang, Y33U};
-    const fchiggs::Hdown hd{ang};
+    const auto cuts = fchiggs::fiducialCuts();
+    if (cuts.active()) { message(appname, "cuts: " + cuts.str()); }
+    const fchiggs::Production prod{fchiggs::Process::H, pdf, SBEAM,
+                                   mh, ang, cuts};
 
-    message(appname, "integrating for cross section ...");
-    double sum_w = 0, sum_w_sq = 0;
-    for (auto itry = 0; itry != N; ++itry) {
-        const double w = weight(rho, pdf, mh, hu, hd, ang);
-        sum_w += w;
-        sum_w_sq += w * w;
+    const auto method = fchiggs::integrationMethod();
+    message(appname, "integrating for cross section" +
+                         fchiggs::methodLabel(method) + " ...");
+    std::ofstream diag;
+    if (const char *fname = std::getenv("FCHIGGS_DIAGNOSTICS")) {
+        diag.open(fname);
+    }
+    // the derivatives come from the same events as the cross section.
+    const bool gradient = std::getenv("FCHIGGS_GRADIENT") != nullptr;
+    // the cache is not used for the derivatives.
+    const auto cache = gradient ? nullptr : fchiggs::resultCache();
+    std::uint64_t nevent = N, seed = fchiggs::randomSeed();
+    std::pair<double, double> result;
+    fchiggs::XsecGradient grad;
+    {
+        const fchiggs::Telemetry telemetry{appname, N};
+        if (gradient) {
+            grad = fchiggs::integrate_gradient(prod, N, method);
+            result = grad.sigma;
+        } else {
+            result = fchiggs::integrate(cache.get(), prod, N, method,
+                                        diag.is_open() ? &diag : nullptr,
+                                        &nevent, &seed);
+        }
     }
-
-    auto result = fchiggs::sigma(sum_w, sum_w_sq, N);
     const double sigma = result.first, err = result.second;
     message(appname, "... done.");
+    if (cache) {
+        message(appname, "the cache `" + cache->directory() + "' has " +
+                             to_string(nevent) + " events.");
+    }
     message(appname, "total cross section = " + to_string(sigma) + " +- " +
                          to_string(err) + " pb");
+    if (gradient) {
+        message(appname, "d sigma / d tan(beta) = " +
+                             to_string(grad.d_tan_beta.first) + " +- " +
+                             to_string(grad.d_tan_beta.second) + " pb");
+        message(appname, "d sigma / d cos(alpha-beta) = " +
+                             to_string(grad.d_cos_alpha_beta.first) + " +- " +
+                             to_string(grad.d_cos_alpha_beta.second) + " pb");
+    }
 
     if (argc == 5) {
-        std::ofstream fout;
-        fout.open(argv[4], std::ios_base::app);
-        fout << std::right << std::fixed << std::setw(7) << std::setprecision(2)
-             << mh << std::setw(14) << std::setprecision(9) << sigma
-             << std::setw(14) << err << '\n';
-        message(appname,
-                "the output has been saved to `" + std::string(argv[4]) + "'.");
+        const std::string fname{argv[4]};
+        if (fchiggs::isResultFile(fname)) {
+            fchiggs::Record rec{fchiggs::Source::PphNeutral, mh, tan_beta,
+                                cos_alpha_beta};
+            rec.sigma = sigma;
+            rec.error = err;
+            rec.n = nevent;
+            rec.seed = seed;
+            if (!fchiggs::appendRecord(fname, rec)) {
+                message(appname, "failed to write to `" + fname + "'.");
+                return 1;
+            }
+        } else {
+            std::ofstream fout;
+            fout.open(fname, std::ios_base::app);
+            fout << std::right << std::fixed << std::setw(7)
+                 << std::setprecision(2) << mh << std::setw(14)
+                 << std::setprecision(9) << sigma << std::setw(14) << err
+                 << '\n';
+        }
+        message(appname, "the output has been saved to `" + fname + "'.");
     }
 }
-
-double weight(const fchiggs::Rho &rho, const std::shared_ptr<LHAPDF::PDF> &pdf,
-              const double mh, const fchiggs::Hup &hu, const fchiggs::Hdown &hd,
-              const fchiggs::Angles &ang) {
-    const double val = fchiggs::rhoValue(rho);
-    const double shat = rho.shat(val);
-    const double gammah = mh / 10000.0;
-
-    const double mu = mh;  // renormalization and factorization scales
-    const double alpha_s = pdf->alphasQ(mu);
-    const fchiggs::InitPartons p{SBEAM, shat};
-
-    return fchiggs::dsigma_h(pdf, p, mu, mh, gammah, alpha_s, hu, hd, ang,
-                             KGG) *
-           rho.delta() * p.delta_y() * rho.jacobian(val);
-}
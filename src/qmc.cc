@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "qmc.h"
+#include <array>
+#include <cstdint>
+#include "utils.h"
+
+namespace fchiggs {
+struct DirectionNumbers {
+    unsigned int s, a;
+    std::array<std::uint32_t, 5> m;
+};
+
+// dimensions 2--8 of new-joe-kuo-6.21201.
+constexpr DirectionNumbers JOEKUO[] = {{1, 0, {{1}}},
+                                       {2, 1, {{1, 3}}},
+                                       {3, 1, {{1, 3, 1}}},
+                                       {3, 2, {{1, 1, 1}}},
+                                       {4, 1, {{1, 1, 3, 3}}},
+                                       {4, 4, {{1, 3, 5, 13}}},
+                                       {5, 2, {{1, 1, 5, 5, 17}}}};
+
+std::uint32_t randomBits() {
+    return static_cast<std::uint32_t>(getRandom() * 4294967296.0);
+}
+
+unsigned int parity(std::uint32_t x) {
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1u;
+}
+
+void Sobol::init() {
+    if (dim_ == 0 || dim_ > MAXDIM) { dim_ = MAXDIM; }
+
+    for (unsigned int k = 0; k != NBITS; ++k) {
+        base_[0][k] = 1u << (NBITS - 1 - k);
+    }
+    for (unsigned int d = 1; d != MAXDIM; ++d) {
+        const DirectionNumbers &dn = JOEKUO[d - 1];
+        auto &v = base_[d];
+        for (unsigned int k = 0; k != NBITS; ++k) {
+            if (k < dn.s) {
+                v[k] = dn.m[k] << (NBITS - 1 - k);
+                continue;
+            }
+            v[k] = v[k - dn.s] ^ (v[k - dn.s] >> dn.s);
+            for (unsigned int j = 1; j != dn.s; ++j) {
+                if ((dn.a >> (dn.s - 1 - j)) & 1u) { v[k] ^= v[k - j]; }
+            }
+        }
+    }
+    randomize();
+}
+
+void Sobol::randomize() {
+    for (unsigned int d = 0; d != dim_; ++d) {
+        // the rows of a random lower-triangular matrix with the unit
+        // diagonal. The digits are counted from the most significant bit.
+        std::array<std::uint32_t, NBITS> row;
+        for (unsigned int i = 0; i != NBITS; ++i) {
+            const std::uint32_t diag = 1u << (NBITS - 1 - i);
+            row[i] = i == 0 ? diag : diag | (randomBits() & ~(2 * diag - 1));
+        }
+        for (unsigned int k = 0; k != NBITS; ++k) {
+            std::uint32_t scrambled = 0;
+            for (unsigned int i = 0; i != NBITS; ++i) {
+                if (parity(base_[d][k] & row[i])) {
+                    scrambled |= 1u << (NBITS - 1 - i);
+                }
+            }
+            v_[d][k] = scrambled;
+        }
+        x_[d] = randomBits();  // digital shift
+    }
+    index_ = 0;
+}
+
+void Sobol::next(double *u) {
+    for (unsigned int d = 0; d != dim_; ++d) {
+        u[d] = (x_[d] + 0.5) / 4294967296.0;
+    }
+
+    // Gray code ordering: flip the direction number of the lowest zero bit.
+    unsigned int c = 0;
+    for (std::uint32_t i = index_; i & 1u; i >>= 1) { ++c; }
+    for (unsigned int d = 0; d != dim_; ++d) { x_[d] ^= v_[d][c]; }
+    ++index_;
+}
+}  // namespace fchiggs
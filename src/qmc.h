@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_QMC_H_
+#define FCHIGGS_SRC_QMC_H_
+
+#include <array>
+#include <cstdint>
+
+namespace fchiggs {
+/**
+ *  Scrambled Sobol sequence in up to MAXDIM dimensions.
+ *
+ *  The direction numbers are from S. Joe and F. Y. Kuo,
+ *  SIAM J. Sci. Comput. 30, 2635 (2008). Each randomization applies a
+ *  random linear matrix scrambling and a random digital shift
+ *  (J. Matousek, J. Complexity 14, 527 (1998)), so that the points of
+ *  independent randomizations give unbiased and independent estimates.
+ */
+class Sobol {
+public:
+    static constexpr unsigned int MAXDIM = 8;
+    static constexpr unsigned int NBITS = 32;
+
+private:
+    unsigned int dim_;
+    std::uint32_t index_;
+    std::array<std::array<std::uint32_t, NBITS>, MAXDIM> base_, v_;
+    std::array<std::uint32_t, MAXDIM> x_;
+
+public:
+    Sobol() = delete;
+    explicit Sobol(const unsigned int dim) : dim_{dim} { init(); }
+
+    unsigned int dim() const { return dim_; }
+
+    /** starts a new independent randomization of the sequence. */
+    void randomize();
+
+    /** the next point in (0, 1)^dim. */
+    void next(double *u);
+
+private:
+    void init();
+};
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_QMC_H_
@@ -0,0 +1,263 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "results.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "temp_file.h"
+
+namespace fchiggs {
+constexpr char MAGIC[] = "FCHRES01";
+constexpr std::size_t NFIXED = 12;  // the columns before the BRs
+constexpr std::size_t NCOLUMNS = NFIXED + NBRNEUTRAL + NBRCHARGED;
+
+void Record::setBR(const HiggsDecayWidth &hdecay) {
+    const auto brs = hdecay.branchingRatios();
+    for (std::size_t i = 0; i != NBRNEUTRAL; ++i) {
+        br_neutral[i] = brs[i].second;
+    }
+}
+
+void Record::setBR(const ChargedHiggsDecayWidth &hdecay) {
+    const auto brs = hdecay.branchingRatios();
+    for (std::size_t i = 0; i != NBRCHARGED; ++i) {
+        br_charged[i] = brs[i].second;
+    }
+}
+
+bool isResultFile(const std::string &fname) {
+    return fname.size() > 4 && fname.compare(fname.size() - 4, 4, ".fcr") == 0;
+}
+
+const std::vector<std::string> &columnNames() {
+    static const std::vector<std::string> names{
+        "source",      "mh",          "tan_beta",   "cos_alpha_beta",
+        "sigma",       "error",       "n",          "seed",
+        "mzp",         "gzpx",        "mu",         "vs",
+        "br_h_bq",     "br_h_cc",     "br_h_bb",    "br_h_tt",
+        "br_h_mumu",   "br_h_tautau", "br_h_ww",    "br_h_zz",
+        "br_h_zpzp",   "br_h_aa",     "br_h_gg",    "br_h_hh",
+        "br_hpm_tb",   "br_hpm_cb",   "br_hpm_ub",  "br_hpm_cs",
+        "br_hpm_cd",   "br_hpm_taunu", "br_hpm_munu", "br_hpm_wh"};
+    return names;
+}
+
+namespace {
+bool isInteger(const std::size_t col) {
+    return col == 0 || col == 6 || col == 7;
+}
+
+std::uint64_t fromDouble(const double x) {
+    std::uint64_t raw;
+    std::memcpy(&raw, &x, sizeof raw);
+    return raw;
+}
+
+double toDouble(const std::uint64_t raw) {
+    double x;
+    std::memcpy(&x, &raw, sizeof x);
+    return x;
+}
+
+std::uint64_t getField(const Record &rec, const std::size_t col) {
+    switch (col) {
+    case 0: return static_cast<std::uint64_t>(rec.source);
+    case 1: return fromDouble(rec.mh);
+    case 2: return fromDouble(rec.tan_beta);
+    case 3: return fromDouble(rec.cos_alpha_beta);
+    case 4: return fromDouble(rec.sigma);
+    case 5: return fromDouble(rec.error);
+    case 6: return rec.n;
+    case 7: return rec.seed;
+    case 8: return fromDouble(rec.mzp);
+    case 9: return fromDouble(rec.gzpx);
+    case 10: return fromDouble(rec.mu);
+    case 11: return fromDouble(rec.vs);
+    }
+    if (col < NFIXED + NBRNEUTRAL) {
+        return fromDouble(rec.br_neutral[col - NFIXED]);
+    }
+    return fromDouble(rec.br_charged[col - NFIXED - NBRNEUTRAL]);
+}
+
+void setField(Record &rec, const std::size_t col, const std::uint64_t raw) {
+    switch (col) {
+    case 0: rec.source = static_cast<Source>(raw); return;
+    case 1: rec.mh = toDouble(raw); return;
+    case 2: rec.tan_beta = toDouble(raw); return;
+    case 3: rec.cos_alpha_beta = toDouble(raw); return;
+    case 4: rec.sigma = toDouble(raw); return;
+    case 5: rec.error = toDouble(raw); return;
+    case 6: rec.n = raw; return;
+    case 7: rec.seed = raw; return;
+    case 8: rec.mzp = toDouble(raw); return;
+    case 9: rec.gzpx = toDouble(raw); return;
+    case 10: rec.mu = toDouble(raw); return;
+    case 11: rec.vs = toDouble(raw); return;
+    }
+    if (col < NFIXED + NBRNEUTRAL) {
+        rec.br_neutral[col - NFIXED] = toDouble(raw);
+    } else if (col < NCOLUMNS) {
+        rec.br_charged[col - NFIXED - NBRNEUTRAL] = toDouble(raw);
+    }
+}
+
+std::string header() {
+    std::string hdr{MAGIC, 8};
+    const auto &names = columnNames();
+    const std::uint32_t ncol = names.size();
+    hdr.append(reinterpret_cast<const char *>(&ncol), sizeof ncol);
+    for (std::size_t col = 0; col != names.size(); ++col) {
+        hdr.push_back(isInteger(col) ? 'u' : 'd');
+        hdr.push_back(static_cast<char>(names[col].size()));
+        hdr.append(names[col]);
+    }
+    return hdr;
+}
+
+/**
+ * creates the file with the header. It is written to a temporary file
+ * first and then linked, so other jobs never see a partial header. The
+ * temporary files of the jobs killed before are removed then.
+ */
+bool createResultFile(const std::string &fname) {
+    const auto slash = fname.rfind('/');
+    if (slash == std::string::npos) {
+        sweepTemporaries(".", fname);
+    } else {
+        sweepTemporaries(fname.substr(0, slash + 1), fname.substr(slash + 1));
+    }
+    const std::string hdr = header();
+    return writeFile(fname, hdr.data(), hdr.size(), Placement::Create);
+}
+
+}  // namespace
+
+bool appendRecord(const std::string &fname, const Record &rec) {
+    if (::access(fname.c_str(), F_OK) != 0 && !createResultFile(fname)) {
+        return false;
+    }
+
+    // the header of an existing file must be the same as ours.
+    const std::string hdr = header();
+    std::ifstream fin(fname, std::ios::binary);
+    std::string existing(hdr.size(), '\0');
+    if (!fin.read(&existing[0], existing.size()) || existing != hdr) {
+        return false;
+    }
+
+    std::string buf;
+    for (std::size_t col = 0; col != NCOLUMNS; ++col) {
+        const std::uint64_t raw = getField(rec, col);
+        buf.append(reinterpret_cast<const char *>(&raw), sizeof raw);
+    }
+    const int fd = ::open(fname.c_str(), O_WRONLY | O_APPEND);
+    if (fd < 0) { return false; }
+    // a single write, so that the record is never split.
+    const bool ok = ::write(fd, buf.data(), buf.size()) ==
+                    static_cast<ssize_t>(buf.size());
+    ::close(fd);
+    return ok;
+}
+
+std::vector<Record> readRecords(const std::string &fname) {
+    std::ifstream fin(fname, std::ios::binary);
+    const std::string buf{std::istreambuf_iterator<char>(fin),
+                          std::istreambuf_iterator<char>()};
+    std::vector<Record> recs;
+    if (buf.size() < 12 || buf.compare(0, 8, MAGIC) != 0) { return recs; }
+
+    std::uint32_t ncol;
+    std::memcpy(&ncol, buf.data() + 8, sizeof ncol);
+    std::size_t pos = 12;
+    const auto &names = columnNames();
+    std::vector<std::size_t> cols;  // the columns of ours, or NCOLUMNS
+    for (std::uint32_t i = 0; i != ncol; ++i) {
+        if (pos + 2 > buf.size()) { return recs; }
+        const std::size_t len = static_cast<unsigned char>(buf[pos + 1]);
+        const std::string name = buf.substr(pos + 2, len);
+        pos += 2 + len;
+        std::size_t col = 0;
+        while (col != NCOLUMNS && names[col] != name) { ++col; }
+        cols.push_back(col);
+    }
+
+    const std::size_t reclen = 8 * ncol;
+    for (; pos + reclen <= buf.size(); pos += reclen) {
+        Record rec{Source::PphNeutral, 0, 0, 0};
+        for (std::uint32_t i = 0; i != ncol; ++i) {
+            std::uint64_t raw;
+            std::memcpy(&raw, buf.data() + pos + 8 * i, sizeof raw);
+            setField(rec, cols[i], raw);
+        }
+        recs.push_back(rec);
+    }
+    return recs;
+}
+
+std::vector<double> column(const std::vector<Record> &recs,
+                           const std::string &name) {
+    const auto &names = columnNames();
+    std::size_t col = 0;
+    while (col != NCOLUMNS && names[col] != name) { ++col; }
+
+    std::vector<double> values;
+    if (col == NCOLUMNS) { return values; }
+    values.reserve(recs.size());
+    for (const auto &rec : recs) {
+        const std::uint64_t raw = getField(rec, col);
+        values.push_back(isInteger(col) ? static_cast<double>(raw)
+                                        : toDouble(raw));
+    }
+    return values;
+}
+
+/*
+ *  The lines are formatted by snprintf, as the output of HiggsDecayWidth.
+ *  Without the parameters, they are those of the programs before the
+ *  result files.
+ */
+void writeText(std::ostream &os, const Record &rec, const bool params) {
+    char buf[32];
+    const auto put = [&os, &buf](const char *fmt, const double x) {
+        const int len = std::snprintf(buf, sizeof buf, fmt, x);
+        os.write(buf, std::min<int>(len, sizeof buf - 1));
+    };
+    put("%7.2f", rec.mh);
+    if (rec.source == Source::HdecayNeutral) {
+        if (params) {
+            for (const double x : {rec.tan_beta, rec.cos_alpha_beta, rec.mzp,
+                                   rec.gzpx, rec.mu, rec.vs}) {
+                put("%14.8g", x);
+            }
+        }
+        for (const auto br : rec.br_neutral) { put("%12.8f", br); }
+    } else if (rec.source == Source::HdecayCharged) {
+        if (params) {
+            put("%14.8g", rec.tan_beta);
+            put("%14.8g", rec.cos_alpha_beta);
+        }
+        for (const auto br : rec.br_charged) { put("%12.8f", br); }
+    } else {
+        put("%14.9f", rec.sigma);
+        put("%14.9f", rec.error);
+    }
+    os << '\n';
+}
+}  // namespace fchiggs
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_RESULTS_H_
+#define FCHIGGS_SRC_RESULTS_H_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+
+namespace fchiggs {
+/** the programs that write the results. */
+enum class Source : std::uint64_t {
+    PphNeutral,
+    PphbNeutral,
+    PphtCharged,
+    PphbCharged,
+    HdecayNeutral,
+    HdecayCharged
+};
+
+/** the number of branching ratios of H and H^\pm. */
+constexpr std::size_t NBRNEUTRAL = 12;
+constexpr std::size_t NBRCHARGED = 8;
+
+/**
+ *  A single result. The quantities not computed by the source are NaN
+ *  (or zero for the integers).
+ */
+struct Record {
+    Source source;
+    double mh, tan_beta, cos_alpha_beta;
+    double sigma, error;
+    std::uint64_t n, seed;
+    /** the parameters of H -> Z'Z' and H -> hh (m_Z', g_Z'X, mu, v_s). */
+    double mzp, gzpx, mu, vs;
+    std::array<double, NBRNEUTRAL> br_neutral;
+    std::array<double, NBRCHARGED> br_charged;
+
+    Record(const Source src, const double m, const double tb,
+           const double cab)
+        : source{src},
+          mh{m},
+          tan_beta{tb},
+          cos_alpha_beta{cab},
+          sigma{std::numeric_limits<double>::quiet_NaN()},
+          error{std::numeric_limits<double>::quiet_NaN()},
+          n{0},
+          seed{0},
+          mzp{std::numeric_limits<double>::quiet_NaN()},
+          gzpx{std::numeric_limits<double>::quiet_NaN()},
+          mu{std::numeric_limits<double>::quiet_NaN()},
+          vs{std::numeric_limits<double>::quiet_NaN()} {
+        br_neutral.fill(std::numeric_limits<double>::quiet_NaN());
+        br_charged.fill(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    void setBR(const HiggsDecayWidth &hdecay);
+    void setBR(const ChargedHiggsDecayWidth &hdecay);
+};
+
+/**
+ *  The binary result file (`.fcr'). The header describes the columns:
+ *
+ *    char[8]    "FCHRES01"
+ *    uint32     the number of columns
+ *    for each column:
+ *      char     type ('u': uint64, 'd': double)
+ *      uint8    length of the name
+ *      char[]   name
+ *
+ *  and it is followed by the records of 8-byte fields in native byte order.
+ *  Each record is appended with a single write(2) on a file opened with
+ *  O_APPEND, so that concurrent jobs on a local file system do not
+ *  interleave.
+ */
+bool isResultFile(const std::string &fname);
+
+/** the names of the columns in the order of the file. */
+const std::vector<std::string> &columnNames();
+
+/** appends the record, creating the file with the header if necessary. */
+bool appendRecord(const std::string &fname, const Record &rec);
+
+/** all the records of the file, with the columns matched by name. */
+std::vector<Record> readRecords(const std::string &fname);
+
+/** the column of the given name from the records. */
+std::vector<double> column(const std::vector<Record> &recs,
+                           const std::string &name);
+
+/**
+ *  writes the record in the text layout of the program that produced it.
+ *  If params, the lines of the BRs have the parameters of the point after
+ *  m_H, as in the batch mode of hdecay_neutral and hdecay_charged.
+ */
+void writeText(std::ostream &os, const Record &rec, bool params = false);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_RESULTS_H_
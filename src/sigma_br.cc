@@ -0,0 +1,382 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <istream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "alpha_s.h"
+#include "angles.h"
+#include "budget.h"
+#include "cache.h"
+#include "constants.h"
+#include "couplings.h"
+#include "cuts.h"
+#include "gamma_h_charged.h"
+#include "gamma_h_neutral.h"
+#include "pdf.h"
+#include "results.h"
+#include "telemetry.h"
+#include "user_interface.h"
+#include "utils.h"
+#include "xsec.h"
+
+using std::to_string;
+
+constexpr char appname[] = "sigma_br";
+
+constexpr double ECM = 14000.0;
+constexpr double SBEAM = ECM * ECM;
+constexpr char PDFNAME[] = "NNPDF23_lo_as_0130_qed";
+constexpr unsigned int N = 800000;
+constexpr unsigned int NH = 8500000;  // for p p --> H
+constexpr double MHSM = 125.0;
+constexpr double MZP = 400.0;
+constexpr double GZPX = 0.01;
+constexpr double MU = 200.0;
+constexpr double VS = 1000.0;
+/** the rounds after the pilot with FCHIGGS_BUDGET. */
+constexpr unsigned int NROUNDS = 8;
+
+struct Point {
+    double mh, tan_beta, cos_alpha_beta;
+};
+
+struct Channel {
+    fchiggs::Process proc;
+    fchiggs::Source src;
+    std::string name;
+    unsigned int n;
+};
+
+/** all the production processes, of which each sector takes its own. */
+const Channel PROCESSES[] = {
+    {fchiggs::Process::H, fchiggs::Source::PphNeutral, "H", NH},
+    {fchiggs::Process::Hb, fchiggs::Source::PphbNeutral, "Hb", N},
+    {fchiggs::Process::HtCharged, fchiggs::Source::PphtCharged, "Ht", N},
+    {fchiggs::Process::HbCharged, fchiggs::Source::PphbCharged, "Hb", N}};
+
+/** the cross sections of the channels and the BRs at a point. */
+struct Rates {
+    std::vector<std::pair<double, double>> sigma;
+    std::vector<std::uint64_t> n;  // the events of the cross sections
+    // the seeds of their events, or zero if they merge several runs.
+    std::vector<std::uint64_t> seed;
+    std::vector<std::pair<std::string, double>> br;
+};
+
+std::vector<Point> readPoints(std::istream &is) {
+    std::vector<Point> points;
+    Point p;
+    while (is >> p.mh >> p.tan_beta >> p.cos_alpha_beta) {
+        points.push_back(p);
+    }
+    return points;
+}
+
+std::vector<std::pair<std::string, double>> branchingRatios(
+    const bool neutral, const Point &p, const fchiggs::Angles &ang,
+    const fchiggs::Hup &cup, const fchiggs::Hdown &cdown) {
+    if (!neutral) {
+        const fchiggs::ChargedHiggsDecayWidth hdecay{
+            p.mh, MHSM, cup, fchiggs::VHd{cdown}, ang};
+        return hdecay.branchingRatios();
+    }
+    fchiggs::HQuartic lambda_h{MHSM, p.mh, fchiggs::Mu(MU), fchiggs::Vs(VS),
+                               ang};
+    const fchiggs::HiggsDecayWidth hdecay{p.mh,
+                                          MHSM,
+                                          MZP,
+                                          fchiggs::alphaS()(p.mh),
+                                          fchiggs::GZPX(GZPX),
+                                          fchiggs::GH3(lambda_h.trilinear()),
+                                          cup,
+                                          cdown,
+                                          ang};
+    return hdecay.branchingRatios();
+}
+
+/** the key of the BRs, with the parameters of the decays. */
+fchiggs::CacheKey brKey(const bool neutral, const Point &p) {
+    fchiggs::CacheKey key{neutral ? "br_neutral" : "br_charged"};
+    key.add("m_H", p.mh)
+        .add("tan(beta)", p.tan_beta)
+        .add("cos(alpha-beta)", p.cos_alpha_beta)
+        .add("m_HSM", MHSM);
+    if (neutral) {
+        key.add("m_Z'", MZP).add("g_Z'X", GZPX).add("mu", MU).add("v_s", VS);
+    }
+    return key;
+}
+
+/** the BRs at the point, from the cache if it is there. */
+std::vector<std::pair<std::string, double>> cachedBR(
+    const bool neutral, const fchiggs::ResultCache *cache, const Point &p,
+    const fchiggs::Angles &ang, const fchiggs::Hup &cup,
+    const fchiggs::Hdown &cdown) {
+    const auto key = brKey(neutral, p);
+    fchiggs::CacheEntry entry;
+    if (cache && cache->find(key, &entry) && !entry.br.empty()) {
+        return entry.br;
+    }
+    entry.br = branchingRatios(neutral, p, ang, cup, cdown);
+    if (cache) {
+        fchiggs::CacheEntry stored;
+        cache->add(key, entry, &stored);
+    }
+    return entry.br;
+}
+
+Rates computeRates(const bool neutral, const std::vector<Channel> &channels,
+                   const fchiggs::Method &method,
+                   const fchiggs::FiducialCuts &cuts,
+                   const fchiggs::ResultCache *cache,
+                   std::shared_ptr<fchiggs::PartonDensity> pdf,
+                   const Point &p) {
+    // the couplings are built once for the production and the decay.
+    const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+    const fchiggs::Hup cup{ang, Y33U};
+    const fchiggs::Hdown cdown{ang};
+
+    Rates rates;
+    for (const auto &ch : channels) {
+        const fchiggs::Production prod{ch.proc, pdf, SBEAM, p.mh, ang, cuts};
+        std::uint64_t nevent, seed;
+        rates.sigma.push_back(fchiggs::integrate(cache, prod, ch.n, method,
+                                                 nullptr, &nevent, &seed));
+        rates.n.push_back(nevent);
+        rates.seed.push_back(seed);
+    }
+    rates.br = cachedBR(neutral, cache, p, ang, cup, cdown);
+    return rates;
+}
+
+/**
+ *  The rates of all the points with the events allocated across the points
+ *  and the channels by BudgetScheduler within the budget in CPU seconds.
+ */
+std::vector<Rates> scheduleRates(const bool neutral,
+                                 const std::vector<Channel> &channels,
+                                 const fchiggs::FiducialCuts &cuts,
+                                 const fchiggs::ResultCache *cache,
+                                 const double budget,
+                                 const unsigned int nthreads,
+                                 const std::vector<Point> &points) {
+    auto pdf = fchiggs::mkPdf(PDFNAME);
+    std::vector<fchiggs::Production> prods;
+    for (const auto &p : points) {
+        const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+        for (const auto &ch : channels) {
+            prods.emplace_back(ch.proc, pdf, SBEAM, p.mh, ang, cuts);
+        }
+    }
+    fchiggs::BudgetScheduler scheduler{prods, fchiggs::budgetObjective()};
+    scheduler.run(budget, NROUNDS, nthreads);
+
+    std::vector<Rates> rates(points.size());
+    double max_rel = 0;
+    for (std::size_t i = 0; i != points.size(); ++i) {
+        const Point &p = points[i];
+        for (std::size_t j = 0; j != channels.size(); ++j) {
+            const auto k = i * channels.size() + j;
+            const auto sigma = scheduler.result(k);
+            rates[i].sigma.push_back(sigma);
+            rates[i].n.push_back(scheduler.events(k));
+            // the rounds draw from the streams of several threads.
+            rates[i].seed.push_back(0);
+            if (sigma.first > 0) {
+                max_rel = std::max(max_rel, sigma.second / sigma.first);
+            }
+        }
+        const fchiggs::Angles ang{p.tan_beta, p.cos_alpha_beta};
+        const fchiggs::Hup cup{ang, Y33U};
+        const fchiggs::Hdown cdown{ang};
+        rates[i].br = cachedBR(neutral, cache, p, ang, cup, cdown);
+    }
+    message(appname, to_string(scheduler.spent()) +
+                         " CPU seconds used, the largest relative error = " +
+                         to_string(max_rel));
+    return rates;
+}
+
+void writeHeader(std::ostream &os, const std::vector<Channel> &channels,
+                 const Rates &rates) {
+    os << "# m_H tan(beta) cos(alpha-beta)";
+    for (const auto &ch : channels) {
+        os << " sigma(" << ch.name << ") error(" << ch.name << ")";
+    }
+    for (const auto &ch : channels) {
+        for (const auto &br : rates.br) {
+            os << ' ' << ch.name << ':' << br.first;
+        }
+    }
+    os << '\n';
+}
+
+void writeRates(std::ostream &os, const Point &p, const Rates &rates) {
+    os << std::right << std::fixed << std::setw(7) << std::setprecision(2)
+       << p.mh << std::setw(9) << std::setprecision(4) << p.tan_beta
+       << std::setw(9) << p.cos_alpha_beta << std::scientific
+       << std::setprecision(6);
+    for (const auto &sigma : rates.sigma) {
+        os << std::setw(14) << sigma.first << std::setw(14) << sigma.second;
+    }
+    // sigma x BR in pb
+    for (const auto &sigma : rates.sigma) {
+        for (const auto &br : rates.br) {
+            os << std::setw(14) << sigma.first * br.second;
+        }
+    }
+    os << '\n';
+}
+
+bool appendRates(const std::string &fname, const std::vector<Channel> &ch,
+                 const Point &p, const Rates &rates) {
+    for (std::size_t i = 0; i != ch.size(); ++i) {
+        fchiggs::Record rec{ch[i].src, p.mh, p.tan_beta, p.cos_alpha_beta};
+        rec.sigma = rates.sigma[i].first;
+        rec.error = rates.sigma[i].second;
+        rec.n = rates.n[i];
+        rec.seed = rates.seed[i];
+        const bool neutral = fchiggs::neutralHiggs(ch[i].proc);
+        double *brs =
+            neutral ? rec.br_neutral.data() : rec.br_charged.data();
+        if (neutral) {
+            rec.mzp = MZP;
+            rec.gzpx = GZPX;
+            rec.mu = MU;
+            rec.vs = VS;
+        }
+        for (std::size_t j = 0; j != rates.br.size(); ++j) {
+            brs[j] = rates.br[j].second;
+        }
+        if (!fchiggs::appendRecord(fname, rec)) { return false; }
+    }
+    return true;
+}
+
+unsigned int numThreads(const std::size_t npoints) {
+    unsigned int n = std::thread::hardware_concurrency();
+    if (const char *nthreads = std::getenv("FCHIGGS_THREADS")) {
+        n = std::atoi(nthreads);
+    }
+    n = std::min<unsigned int>(std::max(n, 1u), fchiggs::Telemetry::MAXTHREADS);
+    return std::min<std::size_t>(n, std::max<std::size_t>(npoints, 1));
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << appname
+                  << " <neutral|charged> <points> [output]\n"
+                  << "  points: a file of `m_H tan(beta) cos(alpha-beta)'"
+                     " per line, or `-' for stdin\n";
+        return 1;
+    }
+
+    const std::string sector{argv[1]};
+    if (sector != "neutral" && sector != "charged") {
+        std::cerr << appname << ": unknown sector `" << sector << "'\n";
+        return 1;
+    }
+    const bool neutral = sector == "neutral";
+    std::vector<Channel> channels;
+    for (const auto &ch : PROCESSES) {
+        if (fchiggs::neutralHiggs(ch.proc) == neutral) {
+            channels.push_back(ch);
+        }
+    }
+
+    const std::string input{argv[2]};
+    std::vector<Point> points;
+    if (input == "-") {
+        points = readPoints(std::cin);
+    } else {
+        std::ifstream fin{input};
+        points = readPoints(fin);
+    }
+    const unsigned int nthreads = numThreads(points.size());
+    message(appname, "E_{CM} = " + to_string(ECM / 1000.0) + " TeV");
+    message(appname, to_string(points.size()) + " points on " +
+                         to_string(nthreads) + " threads.");
+
+    const auto method = fchiggs::integrationMethod();
+    const auto cuts = fchiggs::fiducialCuts();
+    if (cuts.active()) { message(appname, "cuts: " + cuts.str()); }
+    const auto cache = fchiggs::resultCache();
+    unsigned long total = 0;
+    for (const auto &ch : channels) { total += ch.n; }
+    std::vector<Rates> rates(points.size());
+    if (const char *budget = std::getenv("FCHIGGS_BUDGET")) {
+        message(appname, "scheduling " + to_string(std::atof(budget)) +
+                             " CPU seconds over the points ...");
+        rates = scheduleRates(neutral, channels, cuts, cache.get(),
+                              std::atof(budget), nthreads, points);
+    } else {
+        const fchiggs::Telemetry telemetry{appname, total * points.size()};
+        std::atomic<std::size_t> next{0};
+        const auto worker = [&]() {
+            // the threads share the grid unless it is LHAPDF::PDF itself.
+            auto pdf = fchiggs::mkPdf(PDFNAME);
+            for (std::size_t i = next++; i < points.size(); i = next++) {
+                rates[i] = computeRates(neutral, channels, method, cuts,
+                                        cache.get(), pdf, points[i]);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < nthreads; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &t : threads) { t.join(); }
+    }
+    message(appname, "... done.");
+
+    if (argc == 3) {
+        if (!rates.empty()) { writeHeader(std::cout, channels, rates.front()); }
+        for (std::size_t i = 0; i != points.size(); ++i) {
+            writeRates(std::cout, points[i], rates[i]);
+        }
+        return 0;
+    }
+
+    const std::string fname{argv[3]};
+    if (fchiggs::isResultFile(fname)) {
+        for (std::size_t i = 0; i != points.size(); ++i) {
+            if (!appendRates(fname, channels, points[i], rates[i])) {
+                message(appname, "failed to write to `" + fname + "'.");
+                return 1;
+            }
+        }
+    } else {
+        // the header only once, at the top of a new or empty file.
+        const bool empty = std::ifstream{fname}.peek() ==
+                           std::ifstream::traits_type::eof();
+        std::ofstream fout;
+        fout.open(fname, std::ios_base::app);
+        if (!fout) {
+            message(appname, "failed to write to `" + fname + "'.");
+            return 1;
+        }
+        if (empty && !rates.empty()) {
+            writeHeader(fout, channels, rates.front());
+        }
+        for (std::size_t i = 0; i != points.size(); ++i) {
+            writeRates(fout, points[i], rates[i]);
+        }
+    }
+    message(appname, "the output has been saved to `" + fname + "'.");
+}
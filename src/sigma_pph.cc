@@ -9,12 +9,12 @@
 #include "sigma_pph.h"
 #include <cmath>
 #include <complex>
-#include <memory>
-#include "LHAPDF/LHAPDF.h"
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
+#include "dual.h"
 #include "initial_states.h"
+#include "pdf.h"
 
 using std::complex;
 
@@ -37,21 +37,25 @@ complex<double> fTriangle(const double tau) {
  * Based on Eq.(3.57) in arXiv:hep-ph/0503172.
  * tau is 1/tau_Q. The 3/4 factor is rescaled to 3/2.
  */
-double sigma0(const double mh, const double alpha_s, const Hup &hu,
-              const Hdown &hd, const Angles &ang) {
+template <typename T>
+T sigma0(const double mh, const double alpha_s, const BasicHup<T> &hu,
+         const BasicHdown<T> &hd, const BasicAngles<T> &ang) {
     // SM couplings:
     // const double coup_u = 1.0;
     // const double coup_d = 1.0;
-    const double c1 = ang.cos_alpha() / ang.cos_beta();
-    const double c2 = VEW * ang.sin_alpha_beta() / (SQRT2 * ang.cos_beta());
-    const double coup_u = c1 + c2 * hu.c33() / MT;
-    const double coup_d = c1 + c2 * hd.c33() / MB;
+    const T c1 = ang.cos_alpha() / ang.cos_beta();
+    const T c2 = VEW * ang.sin_alpha_beta() / (SQRT2 * ang.cos_beta());
+    const T coup_u = c1 + c2 * hu.c33() / MT;
+    const T coup_d = c1 + c2 * hd.c33() / MB;
 
     const double mh2 = mh * mh;
 
-    complex<double> a12tau = coup_u * fTriangle(4 * MT2 / mh2);
-    a12tau += coup_d * fTriangle(4 * MB2 / mh2);
-    const double a12tau_sq = std::norm(a12tau);
+    // |coup_u * F(tau_t) + coup_d * F(tau_b)|^2 with the real couplings.
+    const complex<double> ft = fTriangle(4 * MT2 / mh2);
+    const complex<double> fb = fTriangle(4 * MB2 / mh2);
+    const T a12tau_re = coup_u * ft.real() + coup_d * fb.real();
+    const T a12tau_im = coup_u * ft.imag() + coup_d * fb.imag();
+    const T a12tau_sq = a12tau_re * a12tau_re + a12tau_im * a12tau_im;
 
     const double coeff = alpha_s * alpha_s * mh2 / (576 * PI * VEW2);
 
@@ -64,23 +68,28 @@ double delta(const double shat, const double mh, const double gammah) {
            (std::pow(shat - mh * mh, 2) + sgammah * sgammah);
 }
 
-double sigma_gg(const double mh, const double alpha_s, const Hup &hu,
-                const Hdown &hd, const Angles &ang) {
+template <typename T>
+T sigma_gg(const double mh, const double alpha_s, const BasicHup<T> &hu,
+           const BasicHdown<T> &hd, const BasicAngles<T> &ang) {
     return sigma0(mh, alpha_s, hu, hd, ang);
 }
 
-double sigma_bb(const double mh, const Hdown &hd, const Angles &ang) {
+template <typename T>
+T sigma_bb(const double mh, const BasicHdown<T> &hd,
+           const BasicAngles<T> &ang) {
     const double coeff = PI * MB2 / (2.0 * NC * NC * VEW2);
-    const double coup =
+    const T coup =
         ang.cos_alpha() / ang.cos_beta() +
         VEW * ang.sin_alpha_beta() * hd.c33() / (SQRT2 * MB * ang.cos_beta());
     const double beta2 = 1 - 4 * MB2 / (mh * mh);
     return coeff * coup * coup * std::sqrt(beta2);
 }
 
-double sigma_db(const Hdown &hd, const Angles &ang, const DQuark &type) {
+template <typename T>
+T sigma_db(const BasicHdown<T> &hd, const BasicAngles<T> &ang,
+           const DQuark &type) {
     const double coeff = PI / (8.0 * NC * NC);
-    double coup = ang.sin_alpha_beta() / ang.cos_beta();
+    T coup = ang.sin_alpha_beta() / ang.cos_beta();
     if (type == DQuark::Down) {
         coup *= hd.c13();
     } else if (type == DQuark::Strange) {
@@ -91,33 +100,43 @@ double sigma_db(const Hdown &hd, const Angles &ang, const DQuark &type) {
     return coeff * coup * coup;
 }
 
-double dsigma_h(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                const double mu, const double mh, const double gammah,
-                const double alpha_s, const Hup &hu, const Hdown &hd,
-                const Angles &ang, const double kgg) {
+template <typename T>
+T dsigma_h(const PartonDensity &pdf, const InitPartons &p,
+           const double mu, const double mh, const double gammah,
+           const double alpha_s, const BasicHup<T> &hu, const BasicHdown<T> &hd,
+           const BasicAngles<T> &ang, const double kgg) {
     const double x1 = p.x1(), x2 = p.x2();
     const double shat = p.shat();
 
     // g g --> H
-    double sigma = pdf->xfxQ(21, x1, mu) * pdf->xfxQ(21, x2, mu) *
-                   sigma_gg(mh, alpha_s, hu, hd, ang) * kgg;
+    T sigma = pdf.xfxQ(21, x1, mu) * pdf.xfxQ(21, x2, mu) *
+              sigma_gg(mh, alpha_s, hu, hd, ang) * kgg;
 
     // b b --> H
     sigma +=
-        pdf->xfxQ(5, x1, mu) * pdf->xfxQ(-5, x2, mu) * sigma_bb(mh, hd, ang);
+        pdf.xfxQ(5, x1, mu) * pdf.xfxQ(-5, x2, mu) * sigma_bb(mh, hd, ang);
 
-    const double pdf_b = pdf->xfxQ(5, x2, mu), pdf_bbar = pdf->xfxQ(-5, x2, mu);
+    const double pdf_b = pdf.xfxQ(5, x2, mu), pdf_bbar = pdf.xfxQ(-5, x2, mu);
 
     // d b --> H
     auto q_typ = DQuark::Down;
-    sigma += (pdf->xfxQ(1, x1, mu) * pdf_bbar + pdf->xfxQ(-1, x1, mu) * pdf_b) *
+    sigma += (pdf.xfxQ(1, x1, mu) * pdf_bbar + pdf.xfxQ(-1, x1, mu) * pdf_b) *
              sigma_db(hd, ang, q_typ);
 
     // s b --> H
     q_typ = DQuark::Strange;
-    sigma += (pdf->xfxQ(3, x1, mu) * pdf_bbar + pdf->xfxQ(-3, x1, mu) * pdf_b) *
+    sigma += (pdf.xfxQ(3, x1, mu) * pdf_bbar + pdf.xfxQ(-3, x1, mu) * pdf_b) *
              sigma_db(hd, ang, q_typ);
 
     return sigma * delta(shat, mh, gammah) / (x1 * x2);
 }
+
+template double dsigma_h(const PartonDensity &, const InitPartons &,
+                         const double, const double, const double,
+                         const double, const Hup &, const Hdown &,
+                         const Angles &, const double);
+template Grad dsigma_h(const PartonDensity &, const InitPartons &,
+                       const double, const double, const double, const double,
+                       const BasicHup<Grad> &, const BasicHdown<Grad> &,
+                       const BasicAngles<Grad> &, const double);
 }  // namespace fchiggs
@@ -9,17 +9,17 @@
 #ifndef FCHIGGS_SRC_SIGMA_PPH_H_
 #define FCHIGGS_SRC_SIGMA_PPH_H_
 
-#include <memory>
-#include "LHAPDF/LHAPDF.h"
 #include "angles.h"
 #include "couplings.h"
 #include "initial_states.h"
+#include "pdf.h"
 
 namespace fchiggs {
-double dsigma_h(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                const double mu, const double mh, const double gammah,
-                const double alpha_s, const Hup &hu, const Hdown &hd,
-                const Angles &ang, const double kgg);
+template <typename T>
+T dsigma_h(const PartonDensity &pdf, const InitPartons &p,
+           const double mu, const double mh, const double gammah,
+           const double alpha_s, const BasicHup<T> &hu, const BasicHdown<T> &hd,
+           const BasicAngles<T> &ang, const double kgg);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_SIGMA_PPH_H_
@@ -7,59 +7,35 @@
  */
 
 #include "sigma_pphb_neutral.h"
-#include "LHAPDF/LHAPDF.h"
 #include "angles.h"
 #include "constants.h"
 #include "couplings.h"
-#include "initial_states.h"
-#include "pdf.h"
+#include "dual.h"
 #include "sigma_pphq.h"
 
 namespace fchiggs {
-double dsigma_dcos_dg(const double shat, const double mh, const double alpha_s,
-                      const Hdown &hd, const Angles &ang, const DQuark &type) {
-    double g = ang.sin_alpha_beta() / (2 * SQRT2 * ang.cos_beta());
-    if (type == DQuark::Down) {
-        g *= hd.c13();
-    } else if (type == DQuark::Strange) {
-        g *= hd.c23();
-    } else {
-        g *= 0;
-    }
-    double gtilde = g;
-    return dsigma_dcos(shat, mh, 0.0, MB, alpha_s, g, gtilde);
-}
-
-double dsigma_dcos_bg(const double shat, const double mh, const double alpha_s,
-                      const Hdown &hd, const Angles &ang) {
-    double lambda_b = SQRT2 * MB * ang.cos_alpha() / (VEW * ang.cos_beta()) +
-                      hd.c33() * ang.sin_alpha_beta() / ang.cos_beta();
-    double g = lambda_b / (2 * SQRT2);
-    double gtilde = g;
-    return dsigma_dcos(shat, mh, MB, MB, alpha_s, g, gtilde);
-}
+template <typename T>
+Subprocesses<T> subprocesses_hb(const double mh, const BasicHdown<T> &hd,
+                                const BasicAngles<T> &ang) {
+    Subprocesses<T> subs{mh};
 
-double dsigma_dcos_hb(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                      const double mu, const double mh, const double alpha_s,
-                      const Hdown &hd, const Angles &ang) {
-    const double x1 = p.x1(), x2 = p.x2();
-    const double shat = p.shat();
-    const double pdf_g = pdf->xfxQ(21, x2, mu);
-
-    // d g --> H b
-    auto q_typ = DQuark::Down;
-    double sigma = (pdf->xfxQ(1, x1, mu) + pdf->xfxQ(-1, x1, mu)) * pdf_g *
-                   dsigma_dcos_dg(shat, mh, alpha_s, hd, ang, q_typ);
-
-    // s g --> H b
-    q_typ = DQuark::Strange;
-    sigma += (pdf->xfxQ(3, x1, mu) + pdf->xfxQ(-3, x1, mu)) * pdf_g *
-             dsigma_dcos_dg(shat, mh, alpha_s, hd, ang, q_typ);
+    // d g --> H b and s g --> H b
+    const T g_dg = ang.sin_alpha_beta() / (2 * SQRT2 * ang.cos_beta());
+    subs.add(1, 0.0, MB, g_dg * hd.c13(), g_dg * hd.c13());
+    subs.add(3, 0.0, MB, g_dg * hd.c23(), g_dg * hd.c23());
 
     // b g --> H b
-    sigma += (pdf->xfxQ(5, x1, mu) + pdf->xfxQ(-5, x1, mu)) * pdf_g *
-             dsigma_dcos_bg(shat, mh, alpha_s, hd, ang);
+    const T lambda_b = SQRT2 * MB * ang.cos_alpha() / (VEW * ang.cos_beta()) +
+                       hd.c33() * ang.sin_alpha_beta() / ang.cos_beta();
+    const T g_bg = lambda_b / (2 * SQRT2);
+    subs.add(5, MB, MB, g_bg, g_bg);
 
-    return sigma / (x1 * x2);
+    return subs;
 }
+
+template Subprocesses<double> subprocesses_hb(const double, const Hdown &,
+                                              const Angles &);
+template Subprocesses<Grad> subprocesses_hb(const double,
+                                            const BasicHdown<Grad> &,
+                                            const BasicAngles<Grad> &);
 }  // namespace fchiggs
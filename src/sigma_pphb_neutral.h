@@ -9,16 +9,15 @@
 #ifndef FCHIGGS_SRC_SIGMA_PPHB_NEUTRAL_H_
 #define FCHIGGS_SRC_SIGMA_PPHB_NEUTRAL_H_
 
-#include <memory>
-#include "LHAPDF/LHAPDF.h"
 #include "angles.h"
 #include "couplings.h"
-#include "initial_states.h"
+#include "sigma_pphq.h"
 
 namespace fchiggs {
-double dsigma_dcos_hb(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                      const double mu, const double mh, const double alpha_s,
-                      const Hdown &hd, const Angles &ang);
+/** d g, s g and b g --> H b, which share the gluon PDF at x2. */
+template <typename T>
+Subprocesses<T> subprocesses_hb(const double mh, const BasicHdown<T> &hd,
+                                const BasicAngles<T> &ang);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_SIGMA_PPHB_NEUTRAL_H_
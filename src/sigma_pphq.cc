@@ -8,40 +8,269 @@
 
 #include "sigma_pphq.h"
 #include <cmath>
-#include "kinematics.h"
+#include "dual.h"
 #include "utils.h"
 
 namespace fchiggs {
+namespace {
+/** the ranges of t = (p1 - k2)^2 and u = (p1 - p2)^2. */
+struct Invariants {
+    double tmin, tmax, umin, umax;
+    double dt_dcos;  // = 2 |p1| |k2| in the CM frame
+};
+
+/*
+ *  a + b and a - b, or a alone if the mass term b is known to vanish. The
+ *  condition is a constant, so the dead terms are folded away, which the
+ *  compiler may not do for a literal zero in IEEE arithmetic.
+ */
+template <bool Keep>
+inline double plus(const double a, const double b) {
+    return Keep ? a + b : a;
+}
+
+template <bool Keep>
+inline double minus(const double a, const double b) {
+    return Keep ? a - b : a;
+}
+
+/** whether q (IN) and q' (OUT) are massive in the case M. */
+template <QuarkMasses M>
+struct Massive {
+    static constexpr bool IN = M == QuarkMasses::Both;
+    static constexpr bool OUT = M != QuarkMasses::None;
+};
+
+/*
+ *  The extrema close to zero are obtained from the products t_max t_min
+ *  and u_max u_min without cancellations, so that the collinear regions,
+ *  t --> m_qout^2 and u --> 0, are accurate.
+ */
+template <QuarkMasses M>
+Invariants invariants(const double s, const double mh2, const double mqin2,
+                      const double mqout2) {
+    constexpr bool IN = Massive<M>::IN, OUT = Massive<M>::OUT;
+    // the momenta and the energies of qin, H and qout in the CM frame.
+    const double e = 2 * std::sqrt(s);
+    const double pin = minus<IN>(s, mqin2) / e,
+                 pfin = lambda12(s, mh2, mqout2) / e;
+    const double ein = plus<IN>(s, mqin2) / e;
+    const double eh = minus<OUT>(s + mh2, mqout2) / e,
+                 eout = plus<OUT>(s - mh2, mqout2) / e;
+
+    Invariants inv;
+    inv.tmin = plus<IN>(mh2, mqin2) - 2 * (ein * eh + pin * pfin);
+    inv.umin = (IN ? mqin2 + mqout2 : mqout2) - 2 * (ein * eout + pin * pfin);
+    if (IN) {
+        inv.tmax = (mqout2 * (mh2 - mqin2) +
+                    (mqin2 + mqout2 - mh2) * mqin2 * mqout2 / s) /
+                   inv.tmin;
+        inv.umax = (mh2 * (mqout2 - mqin2) +
+                    (mqin2 + mh2 - mqout2) * mqin2 * mh2 / s) /
+                   inv.umin;
+    } else {
+        inv.tmax = OUT ? mqout2 * mh2 / inv.tmin : 0.0;
+        inv.umax = OUT ? mh2 * mqout2 / inv.umin : 0.0;
+    }
+    inv.dt_dcos = 2 * pin * pfin;
+    return inv;
+}
+}  // namespace
+
+QuarkMasses quarkMasses(const double mqin, const double mqout) {
+    if (mqin != 0) { return QuarkMasses::Both; }
+    return mqout == 0 ? QuarkMasses::None : QuarkMasses::Out;
+}
+
+namespace {
+/** dsigma/dt at the cos(theta) of H in the partonic CM frame. */
 double dsigma_dt(const double shat, const double mh, const double mqin,
                  const double mqout, const double alpha_s, const double g,
-                 const double gtilde) {
-    if (shat < std::pow(mh + mqout, 2)) { return 0.0; }
+                 const double gtilde, const double cth) {
+    if (shat < (mh + mqout) * (mh + mqout)) { return 0.0; }
 
-    CM22 pmom{shat, mh, mqin, mqout};
-    double s = shat, t = pmom.t_hat();
-    double mh2 = mh * mh, mqin2 = mqin * mqin, mqout2 = mqout * mqout;
+    const double s = shat;
+    const double mh2 = mh * mh, mqin2 = mqin * mqin, mqout2 = mqout * mqout;
+    const auto inv = invariants<QuarkMasses::Both>(s, mh2, mqin2, mqout2);
+    const double t = inv.tmax - inv.dt_dcos * (1.0 - cth);
+    const double u = inv.umax - inv.dt_dcos * (1.0 + cth);
 
-    double F1 = s * t - mqin2 * mqout2, F2 = s + t - mqin2 - mqout2;
-    double G1 = mh2 - mqout2 - s, G2 = mh2 - mqin2 - t;
-    double SS = s - mqin2, TT = t - mqout2;
-    double g2 = g * g, gt2 = gtilde * gtilde;
+    const double F1 = s * t - mqin2 * mqout2;
+    const double G1 = mh2 - mqout2 - s, G2 = mh2 - mqin2 - t;
+    const double SS = s - mqin2, TT = t - mqout2;
+    const double g2 = g * g, gt2 = gtilde * gtilde;
 
-    double sigma =
-        (g2 + gt2) * ((2 * F1 - F2 * F2 - 2 * G1 * G2) / (SS * TT) +
-                      2 * mqin2 * G1 / (SS * SS) + 2 * mqout2 * G2 / (TT * TT));
-    sigma += (g2 - gt2) * 4.0 * mqin * mqout * mh2 / (SS * TT) *
-             (1.0 - F1 * F2 / (mh2 * SS * TT));
+    // 2 F1 - F2^2 - 2 G1 G2 with F2 = s + t - mqin^2 - mqout^2.
+    const double num = -(mh2 * mh2 + u * u) + 2 * mqin2 * (2 * mh2 - s) +
+                       2 * mqout2 * (2 * mh2 - t) - 4 * mqin2 * mqout2;
+    double sigma = (g2 + gt2) * (num / (SS * TT) + 2 * mqin2 * G1 / (SS * SS) +
+                                 2 * mqout2 * G2 / (TT * TT));
+    // mh^2 SS TT - F1 F2
+    const double num2 =
+        F1 * u - mh2 * (s * mqout2 + mqin2 * t - 2 * mqin2 * mqout2);
+    sigma += (g2 - gt2) * (4 * mqin * mqout * num2 / (SS * TT * SS * TT));
 
-    sigma *= alpha_s / (8.0 * NC * SS * SS);
+    sigma *= alpha_s / (8 * NC * SS * SS);
     return sigma;
 }
+}  // namespace
 
 double dsigma_dcos(const double shat, const double mh, const double mqin,
                    const double mqout, const double alpha_s, const double g,
                    const double gtilde) {
-    double dsigma = dsigma_dt(shat, mh, mqin, mqout, alpha_s, g, gtilde);
-    double jacobian = 0.5 * (shat - mqin * mqin) *
-                      lambda12(shat, mh * mh, mqout * mqout) / shat;
+    const double dsigma =
+        dsigma_dt(shat, mh, mqin, mqout, alpha_s, g, gtilde, costh(DELTA));
+    const double jacobian =
+        (shat - mqin * mqin) * lambda12(shat, mh * mh, mqout * mqout) /
+        (2 * shat);
     return dsigma * jacobian;
 }
+
+template <QuarkMasses M>
+SigmaHatFactors sigma_hat_factors(const double shat, const double mh,
+                                  const double mqin, const double mqout,
+                                  const double alpha_s, const double cmin,
+                                  const double cmax) {
+    if (shat < (mh + mqout) * (mh + mqout)) { return {0, 0}; }
+
+    constexpr bool IN = Massive<M>::IN, OUT = Massive<M>::OUT;
+    const auto inv = invariants<M>(shat, mh * mh, mqin * mqin, mqout * mqout);
+
+    // the integrals of 1, TT, 1 / TT and 1 / TT^2 over the range of TT,
+    // which is linear in cos(theta). The ends of the full range are taken
+    // from the accurate extrema of t, since TT is small near the threshold
+    // and at the collinear limit.
+    const double mq2 = mqout * mqout;
+    const double tt2 = minus<OUT>(inv.tmax, mq2);
+    const double tt1 = cmin == -1 ? minus<OUT>(inv.tmin, mq2)
+                                  : tt2 - inv.dt_dcos * (1 - cmin);
+    const double ttc = cmax == 1 ? tt2 : tt2 - inv.dt_dcos * (1 - cmax);
+    const double i0 = inv.dt_dcos * (cmax - cmin);
+    const double i1 = i0 * (tt1 + ttc) / 2;
+    const double il = std::log(ttc / tt1);
+    const double i2 = i0 / (tt1 * ttc);
+
+    const double s = shat, mh2 = mh * mh, mqin2 = mqin * mqin, mqout2 = mq2;
+
+    // dsigma/dt is a0 + a1 TT + b1 / TT + b2 / TT^2 in TT = t - mqout^2
+    // for g^2 + gtilde^2, and c0 + d1 / TT + d2 / TT^2 for g^2 - gtilde^2,
+    // where u = c - TT. The latter needs both masses.
+    const double SS = minus<IN>(s, mqin2), c = plus<IN>(mh2, mqin2) - s;
+    const double k0 = minus<IN>(
+        plus<OUT>(plus<IN>(-(mh2 * mh2 + c * c), 2 * mqin2 * (2 * mh2 - s)),
+                  2 * mqout2 * (2 * mh2 - mqout2)),
+        4 * mqin2 * mqout2);
+    const double a0 = plus<IN>(2 * minus<OUT>(c, mqout2) / SS,
+                               2 * mqin2 * (mh2 - mqout2 - s) / (SS * SS));
+    const double a1 = -1 / SS;
+    const double b1 = minus<OUT>(k0 / SS, 2 * mqout2);
+    const double b2 = 2 * mqout2 * (minus<IN>(mh2, mqin2) - mqout2);
+
+    const double norm = alpha_s / (8 * NC * SS * SS);
+    const double even = plus<OUT>(a0 * i0 + a1 * i1 + b1 * il, b2 * i2) * norm;
+    if (!IN) { return {even, 0}; }
+
+    const double m = 4 * mqin * mqout / (SS * SS);
+    const double c0 = -m * s;
+    const double d1 = m * (s * c - mqout2 * SS - mh2 * mqin2);
+    const double d2 = m * mqout2 * SS * (c - mh2);
+    return {even, (c0 * i0 + d1 * il + d2 * i2) * norm};
+}
+
+template <typename T>
+T sigma_hat(const double shat, const double mh, const double mqin,
+            const double mqout, const double alpha_s, const T &g,
+            const T &gtilde) {
+    const auto f = sigma_hat_factors(shat, mh, mqin, mqout, alpha_s);
+    T g2 = g * g, gt2 = gtilde * gtilde;
+    return (g2 + gt2) * f.even + (g2 - gt2) * f.odd;
+}
+
+namespace {
+/** the kernel specialized for the masses of a group. */
+SigmaHatFactors factors(const QuarkMasses kind, const double shat,
+                        const double mh, const double mqin, const double mqout,
+                        const double alpha_s, const CosRange &r) {
+    switch (kind) {
+    case QuarkMasses::None:
+        return sigma_hat_factors<QuarkMasses::None>(shat, mh, mqin, mqout,
+                                                    alpha_s, r.lo, r.hi);
+    case QuarkMasses::Out:
+        return sigma_hat_factors<QuarkMasses::Out>(shat, mh, mqin, mqout,
+                                                   alpha_s, r.lo, r.hi);
+    default:
+        return sigma_hat_factors<QuarkMasses::Both>(shat, mh, mqin, mqout,
+                                                    alpha_s, r.lo, r.hi);
+    }
+}
+}  // namespace
+
+template <typename T>
+void Subprocesses<T>::add(const int id, const double mqin,
+                          const double mqout, const T &g, const T &gtilde) {
+    const T even = g * g + gtilde * gtilde, odd = g * g - gtilde * gtilde;
+    if (isZero(even) && isZero(odd)) { return; }
+
+    for (auto &m : masses_) {
+        if (m.mqin == mqin && m.mqout == mqout) {
+            m.subs.push_back({id, even, odd});
+            return;
+        }
+    }
+    masses_.push_back(
+        {mqin, mqout, quarkMasses(mqin, mqout), {{id, even, odd}}});
+}
+
+template <typename T>
+std::size_t Subprocesses<T>::size() const {
+    std::size_t n = 0;
+    for (const auto &m : masses_) { n += m.subs.size(); }
+    return n;
+}
+
+template <typename T>
+T Subprocesses<T>::sigma(const PartonDensity &pdf, const InitPartons &p,
+                         const double mu, const double alpha_s,
+                         const FiducialCuts &cuts) const {
+    const double x1 = p.x1(), x2 = p.x2(), shat = p.shat();
+
+    T sigma = 0;
+    bool open = false;
+    for (const auto &m : masses_) {
+        // the cuts come first, since they may leave nothing to compute.
+        CosRange r{-1, 1};
+        if (cuts.active()) {
+            r = cuts.range(p.shat(), p.y(), mh_, m.mqout);
+            if (r.empty()) { continue; }
+        }
+        const auto f = factors(m.kind, shat, mh_, m.mqin, m.mqout, alpha_s, r);
+        if (f.even == 0 && f.odd == 0) { continue; }  // below the threshold
+        open = true;
+        for (const auto &sub : m.subs) {
+            const double lum =
+                pdf.xfxQ(sub.id, x1, mu) + pdf.xfxQ(-sub.id, x1, mu);
+            sigma += lum * (sub.even * f.even + sub.odd * f.odd);
+        }
+    }
+    if (!open) { return sigma; }
+    return sigma * pdf.xfxQ(21, x2, mu) / (x1 * x2);
+}
+
+template SigmaHatFactors sigma_hat_factors<QuarkMasses::None>(
+    const double, const double, const double, const double, const double,
+    const double, const double);
+template SigmaHatFactors sigma_hat_factors<QuarkMasses::Out>(
+    const double, const double, const double, const double, const double,
+    const double, const double);
+template SigmaHatFactors sigma_hat_factors<QuarkMasses::Both>(
+    const double, const double, const double, const double, const double,
+    const double, const double);
+template double sigma_hat(const double, const double, const double,
+                          const double, const double, const double &,
+                          const double &);
+template Grad sigma_hat(const double, const double, const double, const double,
+                        const double, const Grad &, const Grad &);
+
+template class Subprocesses<double>;
+template class Subprocesses<Grad>;
 }  // namespace fchiggs
@@ -9,13 +9,94 @@
 #ifndef FCHIGGS_SRC_SIGMA_PPHQ_H_
 #define FCHIGGS_SRC_SIGMA_PPHQ_H_
 
+#include <vector>
+#include "cuts.h"
+#include "initial_states.h"
+#include "pdf.h"
+
 namespace fchiggs {
+/**
+ *  Which of q and q' of q g --> q' H are massive: none, q' only, or both
+ *  (or q only, which is left to the general form). The kernels take it as
+ *  a template parameter and drop the terms of the zero masses at compile
+ *  time, so that the general form, Both, is the only source of the
+ *  formulas. Without q' mass, the cross section diverges in the collinear
+ *  region and is finite only in a range of cos(theta) away from it.
+ */
+enum class QuarkMasses { None, Out, Both };
+
+/** the case of the given masses. */
+QuarkMasses quarkMasses(const double mqin, const double mqout);
+
 /**
  * differential cross secion for qin(p1) g(k1) --> qout(p2) H(k2) process.
  */
 double dsigma_dcos(const double shat, const double mh, const double mqin,
                    const double mqout, const double alpha_s, const double g,
                    const double gtilde);
+
+/** the partonic cross section integrated over cos(theta) analytically. */
+template <typename T>
+T sigma_hat(const double shat, const double mh, const double mqin,
+            const double mqout, const double alpha_s, const T &g,
+            const T &gtilde);
+
+/**
+ *  sigma_hat apart from the couplings, so that sigma_hat is
+ *  even (g^2 + gtilde^2) + odd (g^2 - gtilde^2). Both are zero below the
+ *  threshold. cos(theta) of H is integrated over [cmin, cmax].
+ */
+struct SigmaHatFactors {
+    double even, odd;
+};
+
+template <QuarkMasses M = QuarkMasses::Both>
+SigmaHatFactors sigma_hat_factors(const double shat, const double mh,
+                                  const double mqin, const double mqout,
+                                  const double alpha_s, const double cmin = -1,
+                                  const double cmax = 1);
+
+/**
+ *  The q g --> q' H subprocesses of a process and their charge conjugates
+ *  at a parameter point. The couplings are fixed at the construction, and
+ *  the subprocesses of zero couplings are dropped then. Those with the same
+ *  masses of q and q' share the kinematic factors of each event, so an
+ *  event costs one sigma_hat_factors per pair of masses.
+ */
+template <typename T>
+class Subprocesses {
+private:
+    struct Subprocess {
+        int id;       // the PDG id of q
+        T even, odd;  // g^2 + gtilde^2 and g^2 - gtilde^2
+    };
+    struct Masses {
+        double mqin, mqout;
+        QuarkMasses kind;
+        std::vector<Subprocess> subs;
+    };
+
+    double mh_;
+    std::vector<Masses> masses_;
+
+public:
+    Subprocesses() = delete;
+    explicit Subprocesses(const double mh) : mh_{mh} {}
+
+    /** q g --> q' H with q of the PDG id and the masses of q and q'. */
+    void add(const int id, const double mqin, const double mqout, const T &g,
+             const T &gtilde);
+
+    /** the number of the subprocesses kept. */
+    std::size_t size() const;
+
+    /**
+     *  The sum of the cross sections at the partonic x1 of q and x2 of g
+     *  within the cuts.
+     */
+    T sigma(const PartonDensity &pdf, const InitPartons &p, const double mu,
+            const double alpha_s, const FiducialCuts &cuts) const;
+};
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_SIGMA_PPHQ_H_
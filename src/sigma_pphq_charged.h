@@ -9,20 +9,22 @@
 #ifndef FCHIGGS_SRC_SIGMA_PPHQ_CHARGED_H_
 #define FCHIGGS_SRC_SIGMA_PPHQ_CHARGED_H_
 
-#include <memory>
-#include "LHAPDF/LHAPDF.h"
 #include "angles.h"
 #include "couplings.h"
-#include "initial_states.h"
+#include "sigma_pphq.h"
 
 namespace fchiggs {
-double dsigma_dcos_ht(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                      const double mu, const double mh, const double alpha_s,
-                      const Hup &hu, const Hdown &hd, const Angles &ang);
+/** b g --> H^\pm t */
+template <typename T>
+Subprocesses<T> subprocesses_ht(const double mh, const BasicHup<T> &hu,
+                                const BasicHdown<T> &hd,
+                                const BasicAngles<T> &ang);
 
-double dsigma_dcos_hb(std::shared_ptr<LHAPDF::PDF> pdf, const InitPartons &p,
-                      const double mu, const double mh, const double alpha_s,
-                      const Hdown &hd, const Angles &ang);
+/** u g and c g --> H^\pm b, which share the gluon PDF at x2. */
+template <typename T>
+Subprocesses<T> subprocesses_hb_charged(const double mh,
+                                        const BasicHdown<T> &hd,
+                                        const BasicAngles<T> &ang);
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_SIGMA_PPHQ_CHARGED_H_
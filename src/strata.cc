@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "strata.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "utils.h"
+
+namespace fchiggs {
+void Strata::point(const std::size_t i, double *u) const {
+    std::size_t idx = i;
+    for (unsigned int d = dim_; d != 0; --d) {
+        u[d - 1] = (idx % nbins_ + getRandom()) / nbins_;
+        idx /= nbins_;
+    }
+}
+
+double Strata::variance(const Stratum &c) const {
+    if (c.n < 2) { return 0; }
+    const double m = mean(c);
+    const double var = (c.sum_w_sq / c.n - m * m) * c.n / (c.n - 1.0);
+    return var > 0 ? var : 0;
+}
+
+std::vector<unsigned long> Strata::allocate(const unsigned long n) const {
+    std::vector<unsigned long> alloc(cells_.size(), 2);
+    const unsigned long nmin = 2 * cells_.size();
+    if (n <= nmin) { return alloc; }
+
+    double sum_sd = 0;
+    for (const auto &c : cells_) { sum_sd += std::sqrt(variance(c)); }
+    const unsigned long nfree = n - nmin;
+    for (std::size_t i = 0; i != cells_.size(); ++i) {
+        const double frac = sum_sd > 0
+                                ? std::sqrt(variance(cells_[i])) / sum_sd
+                                : 1.0 / cells_.size();
+        alloc[i] += static_cast<unsigned long>(frac * nfree);
+    }
+    return alloc;
+}
+
+std::pair<double, double> Strata::sum(
+    const std::vector<Stratum> &cells) const {
+    // every stratum has the volume 1 / size().
+    const double vol = 1.0 / cells.size();
+    double integral = 0, var = 0;
+    for (const auto &c : cells) {
+        integral += vol * mean(c);
+        if (c.n > 0) { var += vol * vol * variance(c) / c.n; }
+    }
+    return std::make_pair(integral, var);
+}
+
+void Strata::endPass() {
+    const auto result = sum(pass_);
+    sum_integral_ += result.first;
+    sum_var_ += result.second;
+    ++npass_;
+    for (auto &c : pass_) { c = {0, 0, 0}; }
+}
+
+std::pair<double, double> Strata::estimate() const {
+    double integral = sum_integral_, var = sum_var_;
+    unsigned int npass = npass_;
+    if (std::any_of(pass_.cbegin(), pass_.cend(),
+                    [](const Stratum &c) { return c.n > 0; })) {
+        const auto result = sum(pass_);
+        integral += result.first;
+        var += result.second;
+        ++npass;
+    }
+    if (npass == 0) { return std::make_pair(0.0, 0.0); }
+    return std::make_pair(integral / npass, std::sqrt(var) / npass);
+}
+
+void Strata::print(std::ostream &os, const double conv) const {
+    const double vol = 1.0 / cells_.size();
+    os << "# stratum (bins on each axis), n, integral, error\n";
+    for (std::size_t i = 0; i != cells_.size(); ++i) {
+        const Stratum &c = cells_[i];
+        std::size_t idx = i;
+        std::vector<std::size_t> bins(dim_);
+        for (unsigned int d = dim_; d != 0; --d) {
+            bins[d - 1] = idx % nbins_;
+            idx /= nbins_;
+        }
+        for (const auto b : bins) { os << std::setw(4) << b; }
+        const double err = c.n > 0 ? std::sqrt(variance(c) / c.n) : 0;
+        os << std::setw(12) << c.n << std::scientific << std::setprecision(6)
+           << std::setw(16) << vol * mean(c) * conv << std::setw(16)
+           << vol * err * conv << std::defaultfloat << '\n';
+    }
+}
+}  // namespace fchiggs
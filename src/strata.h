@@ -0,0 +1,95 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_STRATA_H_
+#define FCHIGGS_SRC_STRATA_H_
+
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace fchiggs {
+struct Stratum {
+    double sum_w, sum_w_sq;
+    unsigned long n;
+};
+
+/**
+ *  Equal-volume strata of the unit hypercube with nbins bins on each axis.
+ *
+ *  The events are sampled in passes. The allocation of a pass depends on
+ *  the events of the earlier ones, so a stratum that happened to look flat
+ *  gets few events and keeps its low variance. Each pass is therefore
+ *  estimated from its own events only, for which the allocation is fixed,
+ *  and the passes are averaged.
+ */
+class Strata {
+private:
+    unsigned int dim_, nbins_;
+    /** all the events, for the allocation, and those of the current pass. */
+    std::vector<Stratum> cells_, pass_;
+    /** the sums of the estimates and of the variances of the passes. */
+    double sum_integral_ = 0, sum_var_ = 0;
+    unsigned int npass_ = 0;
+
+public:
+    Strata() = delete;
+    Strata(const unsigned int dim, const unsigned int nbins)
+        : dim_{dim},
+          nbins_{nbins},
+          cells_(ipow(nbins, dim), {0, 0, 0}),
+          pass_(cells_) {}
+
+    std::size_t size() const { return cells_.size(); }
+
+    /** a uniformly distributed point inside the i-th stratum. */
+    void point(const std::size_t i, double *u) const;
+
+    void add(const std::size_t i, const double w) {
+        for (Stratum *c : {&cells_[i], &pass_[i]}) {
+            c->sum_w += w;
+            c->sum_w_sq += w * w;
+            ++c->n;
+        }
+    }
+
+    /** closes the current pass. The next events start a new one. */
+    void endPass();
+
+    /**
+     *  The numbers of events in the strata for n more events, proportional
+     *  to the standard deviations observed so far (Neyman allocation).
+     *  Every stratum gets at least two events.
+     */
+    std::vector<unsigned long> allocate(const unsigned long n) const;
+
+    /**
+     *  The integral and its error over the unit hypercube, the average of
+     *  the passes. A pass that is not closed counts as one.
+     */
+    std::pair<double, double> estimate() const;
+
+    /** the per-stratum estimates in units of the given conversion factor. */
+    void print(std::ostream &os, const double conv) const;
+
+private:
+    static std::size_t ipow(const unsigned int base, const unsigned int exp) {
+        std::size_t n = 1;
+        for (unsigned int i = 0; i != exp; ++i) { n *= base; }
+        return n;
+    }
+
+    double mean(const Stratum &c) const { return c.n ? c.sum_w / c.n : 0; }
+    double variance(const Stratum &c) const;
+
+    /** the integral and its variance from the events in the strata. */
+    std::pair<double, double> sum(const std::vector<Stratum> &cells) const;
+};
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_STRATA_H_
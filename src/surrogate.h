@@ -0,0 +1,263 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_SURROGATE_H_
+#define FCHIGGS_SRC_SURROGATE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "constants.h"
+
+namespace fchiggs {
+/**
+ *  Tensor-product Chebyshev approximation of a quantity over
+ *  (m_H, tan(beta), cos(alpha-beta)). It is header-only so that it can be
+ *  used without linking to fcHiggs and LHAPDF.
+ *
+ *  The binary layout (native byte order) is
+ *
+ *    char[8]     "FCHSURR1"
+ *    uint32      transform (0: none, 1: log)
+ *    uint32[3]   order of each axis
+ *    uint32[3]   log scale of each axis (0 or 1)
+ *    double[3]   lower bounds
+ *    double[3]   upper bounds
+ *    double      truncation error
+ *    double      statistical error
+ *    double[]    coefficients, the last axis running fastest
+ */
+class Surrogate {
+public:
+    static constexpr std::size_t NDIM = 3;
+    static constexpr std::uint32_t MAXORDER = 64;
+
+private:
+    std::uint32_t transform_;
+    std::array<std::uint32_t, NDIM> order_, logscale_;
+    std::array<double, NDIM> lo_, hi_;
+    double trunc_err_, stat_err_;
+    std::vector<double> coeff_;
+
+public:
+    Surrogate() = delete;
+    Surrogate(const bool log_transform,
+              const std::array<std::uint32_t, NDIM> &order,
+              const std::array<std::uint32_t, NDIM> &logscale,
+              const std::array<double, NDIM> &lo,
+              const std::array<double, NDIM> &hi)
+        : transform_(log_transform ? 1 : 0),
+          order_(order),
+          logscale_(logscale),
+          lo_(lo),
+          hi_(hi),
+          trunc_err_(0),
+          stat_err_(0),
+          coeff_(order[0] * order[1] * order[2], 0.0) {}
+    explicit Surrogate(const std::string &fname) { load(fname); }
+
+    /** the k-th Chebyshev node of the axis in the original variable. */
+    double node(const std::size_t axis, const std::uint32_t k) const {
+        const double t =
+            std::cos(PI * (order_[axis] - k - 0.5) / order_[axis]);
+        return fromUnit(axis, t);
+    }
+
+    std::uint32_t order(const std::size_t axis) const { return order_[axis]; }
+    bool logTransform() const { return transform_ == 1; }
+
+    /**
+     *  Fits the coefficients to the values (and their errors) at the nodes,
+     *  the last axis running fastest. If a value is not positive, the log
+     *  would diverge there, so the values themselves are fitted and
+     *  logTransform() becomes false.
+     */
+    void fit(const std::vector<double> &values,
+             const std::vector<double> &errors);
+
+    /**
+     *  The estimated error of the approximation. It is relative if the
+     *  quantity is fitted in the log space.
+     */
+    double error() const { return trunc_err_ + stat_err_; }
+    double truncationError() const { return trunc_err_; }
+    double statisticalError() const { return stat_err_; }
+
+    double operator()(const double mh, const double tan_beta,
+                      const double cos_alpha_beta) const;
+
+    void save(const std::string &fname) const;
+
+private:
+    double toUnit(const std::size_t axis, const double x) const {
+        double t = 0;
+        if (logscale_[axis]) {
+            const double a = std::log(lo_[axis]), b = std::log(hi_[axis]);
+            t = (2.0 * std::log(x) - a - b) / (b - a);
+        } else {
+            t = (2.0 * x - lo_[axis] - hi_[axis]) / (hi_[axis] - lo_[axis]);
+        }
+        return std::max(-1.0, std::min(1.0, t));
+    }
+
+    double fromUnit(const std::size_t axis, const double t) const {
+        if (logscale_[axis]) {
+            const double a = std::log(lo_[axis]), b = std::log(hi_[axis]);
+            return std::exp(0.5 * (a + b + t * (b - a)));
+        }
+        return 0.5 * (lo_[axis] + hi_[axis] + t * (hi_[axis] - lo_[axis]));
+    }
+
+    void load(const std::string &fname);
+};
+
+/** T_0(t), ..., T_{n-1}(t) */
+inline void chebyshevT(const double t, const std::uint32_t n, double *tn) {
+    tn[0] = 1.0;
+    if (n > 1) { tn[1] = t; }
+    for (std::uint32_t j = 2; j < n; ++j) {
+        tn[j] = 2.0 * t * tn[j - 1] - tn[j - 2];
+    }
+}
+
+inline double Surrogate::operator()(const double mh, const double tan_beta,
+                                    const double cos_alpha_beta) const {
+    double t0[MAXORDER], t1[MAXORDER], t2[MAXORDER];
+    chebyshevT(toUnit(0, mh), order_[0], t0);
+    chebyshevT(toUnit(1, tan_beta), order_[1], t1);
+    chebyshevT(toUnit(2, cos_alpha_beta), order_[2], t2);
+
+    const double *c = coeff_.data();
+    double sum = 0;
+    for (std::uint32_t i = 0; i != order_[0]; ++i) {
+        for (std::uint32_t j = 0; j != order_[1]; ++j) {
+            double inner = 0;
+            for (std::uint32_t k = 0; k != order_[2]; ++k) {
+                inner += c[k] * t2[k];
+            }
+            sum += t0[i] * t1[j] * inner;
+            c += order_[2];
+        }
+    }
+    return logTransform() ? std::exp(sum) : sum;
+}
+
+inline void Surrogate::fit(const std::vector<double> &values,
+                           const std::vector<double> &errors) {
+    std::vector<double> f(values);
+    if (std::any_of(f.begin(), f.end(),
+                    [](const double v) { return v <= 0; })) {
+        transform_ = 0;
+    }
+    double max_err = 0;
+    for (std::size_t i = 0; i != f.size(); ++i) {
+        double err = errors[i];
+        if (logTransform()) {
+            err /= f[i];
+            f[i] = std::log(f[i]);
+        }
+        max_err = std::max(max_err, err);
+    }
+
+    // discrete cosine transform along each axis.
+    std::array<std::size_t, NDIM> stride{
+        {order_[1] * order_[2], order_[2], 1}};
+    std::vector<double> tmp(MAXORDER);
+    for (std::size_t axis = 0; axis != NDIM; ++axis) {
+        const std::uint32_t n = order_[axis];
+        for (std::size_t base = 0; base != f.size(); ++base) {
+            if ((base / stride[axis]) % n != 0) { continue; }
+            for (std::uint32_t j = 0; j != n; ++j) {
+                double c = 0;
+                for (std::uint32_t k = 0; k != n; ++k) {
+                    // the nodes are stored in the ascending order.
+                    const double theta = PI * (n - k - 0.5) / n;
+                    c += f[base + k * stride[axis]] * std::cos(j * theta);
+                }
+                tmp[j] = (j == 0 ? 1.0 : 2.0) * c / n;
+            }
+            for (std::uint32_t j = 0; j != n; ++j) {
+                f[base + j * stride[axis]] = tmp[j];
+            }
+        }
+    }
+    coeff_ = f;
+
+    // the highest-order coefficients bound the truncation error, and the
+    // Lebesgue constant of the nodes amplifies the errors at the nodes.
+    trunc_err_ = 0;
+    double lebesgue = 1.0;
+    for (std::size_t idx = 0; idx != coeff_.size(); ++idx) {
+        for (std::size_t axis = 0; axis != NDIM; ++axis) {
+            const std::size_t j = (idx / stride[axis]) % order_[axis];
+            if (order_[axis] > 1 && j + 1 == order_[axis]) {
+                trunc_err_ += std::abs(coeff_[idx]);
+                break;
+            }
+        }
+    }
+    for (std::size_t axis = 0; axis != NDIM; ++axis) {
+        lebesgue *= 1.0 + 2.0 / PI * std::log(order_[axis]);
+    }
+    stat_err_ = lebesgue * max_err;
+}
+
+inline void Surrogate::save(const std::string &fname) const {
+    std::ofstream fout(fname, std::ios::binary | std::ios::trunc);
+    if (!fout) { throw std::runtime_error("cannot write `" + fname + "'"); }
+    fout.write("FCHSURR1", 8);
+    fout.write(reinterpret_cast<const char *>(&transform_), sizeof transform_);
+    fout.write(reinterpret_cast<const char *>(order_.data()),
+               sizeof(std::uint32_t) * NDIM);
+    fout.write(reinterpret_cast<const char *>(logscale_.data()),
+               sizeof(std::uint32_t) * NDIM);
+    fout.write(reinterpret_cast<const char *>(lo_.data()),
+               sizeof(double) * NDIM);
+    fout.write(reinterpret_cast<const char *>(hi_.data()),
+               sizeof(double) * NDIM);
+    fout.write(reinterpret_cast<const char *>(&trunc_err_), sizeof(double));
+    fout.write(reinterpret_cast<const char *>(&stat_err_), sizeof(double));
+    fout.write(reinterpret_cast<const char *>(coeff_.data()),
+               sizeof(double) * coeff_.size());
+}
+
+inline void Surrogate::load(const std::string &fname) {
+    std::ifstream fin(fname, std::ios::binary);
+    char magic[8];
+    if (!fin.read(magic, 8) || std::memcmp(magic, "FCHSURR1", 8) != 0) {
+        throw std::runtime_error("`" + fname + "' is not a surrogate file");
+    }
+    fin.read(reinterpret_cast<char *>(&transform_), sizeof transform_);
+    fin.read(reinterpret_cast<char *>(order_.data()),
+             sizeof(std::uint32_t) * NDIM);
+    fin.read(reinterpret_cast<char *>(logscale_.data()),
+             sizeof(std::uint32_t) * NDIM);
+    fin.read(reinterpret_cast<char *>(lo_.data()), sizeof(double) * NDIM);
+    fin.read(reinterpret_cast<char *>(hi_.data()), sizeof(double) * NDIM);
+    fin.read(reinterpret_cast<char *>(&trunc_err_), sizeof(double));
+    fin.read(reinterpret_cast<char *>(&stat_err_), sizeof(double));
+    for (const auto n : order_) {
+        if (n == 0 || n > MAXORDER) {
+            throw std::runtime_error("`" + fname + "' is corrupted");
+        }
+    }
+    coeff_.resize(order_[0] * order_[1] * order_[2]);
+    if (!fin.read(reinterpret_cast<char *>(coeff_.data()),
+                  sizeof(double) * coeff_.size())) {
+        throw std::runtime_error("`" + fname + "' is truncated");
+    }
+}
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_SURROGATE_H_
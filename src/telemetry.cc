@@ -0,0 +1,148 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "telemetry.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "constants.h"
+
+namespace fchiggs {
+constexpr unsigned int Telemetry::MAXTHREADS;
+std::atomic<Telemetry *> Telemetry::active_{nullptr};
+std::atomic<std::uint64_t> Telemetry::ninstances_{0};
+
+namespace {
+volatile std::sig_atomic_t snapshot_requested = 0;
+
+extern "C" void requestSnapshot(int) { snapshot_requested = 1; }
+
+/** how often the reporter looks for SIGUSR1. */
+constexpr std::chrono::milliseconds POLL{100};
+}  // namespace
+
+Telemetry::Telemetry(const std::string &appname, const std::uint64_t total)
+    : appname_{appname},
+      total_{total},
+      interval_{std::chrono::steady_clock::duration::zero()},
+      start_{std::chrono::steady_clock::now()},
+      done_{false},
+      instance_{ninstances_.fetch_add(1, std::memory_order_relaxed) + 1},
+      nthreads_{0} {
+    for (auto &c : counters_) {
+        c.n.store(0, std::memory_order_relaxed);
+        c.sum_w.store(0, std::memory_order_relaxed);
+        c.sum_w_sq.store(0, std::memory_order_relaxed);
+    }
+    const char *sec = std::getenv("FCHIGGS_TELEMETRY");
+    if (sec) {
+        using std::chrono::steady_clock;
+        interval_ = std::chrono::duration_cast<steady_clock::duration>(
+            std::chrono::duration<double>(std::atof(sec)));
+    }
+    if (const char *fname = std::getenv("FCHIGGS_STATUS")) { status_ = fname; }
+    if (!sec && status_.empty()) { return; }
+
+    std::signal(SIGUSR1, requestSnapshot);
+    active_.store(this, std::memory_order_release);
+    reporter_ = std::thread{&Telemetry::run, this};
+}
+
+Telemetry::~Telemetry() {
+    if (!reporter_.joinable()) { return; }  // not requested
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        done_ = true;
+    }
+    cv_.notify_one();
+    reporter_.join();
+    active_.store(nullptr, std::memory_order_release);
+    std::signal(SIGUSR1, SIG_DFL);
+    if (!status_.empty()) { report(); }  // the final state
+}
+
+void Telemetry::run() {
+    auto next = start_ + interval_;
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (!cv_.wait_for(lock, POLL, [this] { return done_; })) {
+        const auto now = std::chrono::steady_clock::now();
+        const bool periodic = interval_.count() > 0 && now >= next;
+        if (periodic) { next = now + interval_; }
+        if (periodic || snapshot_requested) {
+            snapshot_requested = 0;
+            report();
+        }
+    }
+}
+
+void Telemetry::report() {
+    std::vector<std::uint64_t> per_thread;
+    std::uint64_t n = 0;
+    double sum_w = 0, sum_w_sq = 0;
+    const unsigned int nthreads = std::min(
+        nthreads_.load(std::memory_order_relaxed), MAXTHREADS);
+    for (unsigned int i = 0; i != nthreads; ++i) {
+        const Counter &c = counters_[i];
+        const auto ni = c.n.load(std::memory_order_relaxed);
+        per_thread.push_back(ni);
+        n += ni;
+        sum_w += c.sum_w.load(std::memory_order_relaxed);
+        sum_w_sq += c.sum_w_sq.load(std::memory_order_relaxed);
+    }
+
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_)
+            .count();
+    const double rate = elapsed > 0 ? n / elapsed : 0;
+    const double eta = rate > 0 && total_ > n ? (total_ - n) / rate : 0;
+    double sigma = 0, err = 0;
+    if (n > 1) {
+        const double mean = sum_w / n;
+        const double var = std::max(sum_w_sq / n - mean * mean, 0.0);
+        sigma = mean * PBCONV;
+        err = std::sqrt(var / (n - 1)) * PBCONV;
+    }
+
+    std::ostringstream line;
+    line << appname_ << ": " << n << "/" << total_ << " events ("
+         << (total_ ? 100.0 * n / total_ : 0.0) << "%), " << rate
+         << " events/s, sigma = " << sigma << " +- " << err << " pb, ETA "
+         << eta << " s";
+    if (per_thread.size() > 1) {
+        line << ", threads:";
+        for (const auto ni : per_thread) { line << ' ' << ni; }
+    }
+    std::cerr << line.str() << '\n';
+
+    if (status_.empty()) { return; }
+    const std::string tmp = status_ + ".tmp";
+    {
+        std::ofstream fout{tmp};
+        fout << "{\"app\": \"" << appname_ << "\", \"events\": " << n
+             << ", \"total\": " << total_ << ", \"elapsed\": " << elapsed
+             << ", \"rate\": " << rate << ", \"eta\": " << eta
+             << ", \"sigma\": " << sigma << ", \"error\": " << err
+             << ", \"threads\": [";
+        for (std::size_t i = 0; i != per_thread.size(); ++i) {
+            fout << (i ? ", " : "") << per_thread[i];
+        }
+        fout << "]}\n";
+    }
+    // readers of the status file never see it half written.
+    std::rename(tmp.c_str(), status_.c_str());
+}
+}  // namespace fchiggs
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_TELEMETRY_H_
+#define FCHIGGS_SRC_TELEMETRY_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace fchiggs {
+/**
+ *  The progress of a running integration.
+ *
+ *  If FCHIGGS_TELEMETRY or FCHIGGS_STATUS is set, the weights passed to
+ *  record() while an instance is alive are counted per thread with relaxed
+ *  atomics. A reporter thread prints the number of events, the rate, the
+ *  running cross section and the ETA to stderr every FCHIGGS_TELEMETRY
+ *  seconds, and to the file FCHIGGS_STATUS in JSON. SIGUSR1 prints a
+ *  snapshot at once. Otherwise, the instance does nothing.
+ *
+ *  The running cross section is the plain average of the weights so far.
+ *  It is only indicative for the stratified sampling, where the events are
+ *  not uniform in the unit hypercube.
+ */
+class Telemetry {
+public:
+    static constexpr unsigned int MAXTHREADS = 64;
+
+private:
+    struct alignas(64) Counter {
+        std::atomic<std::uint64_t> n;
+        std::atomic<double> sum_w, sum_w_sq;
+    };
+
+    std::string appname_;
+    std::uint64_t total_;
+    std::string status_;
+    std::chrono::steady_clock::duration interval_;
+    std::chrono::steady_clock::time_point start_;
+    std::array<Counter, MAXTHREADS> counters_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_;
+    std::thread reporter_;
+    /** the number of this instance, and of the threads that counted in it. */
+    const std::uint64_t instance_;
+    std::atomic<unsigned int> nthreads_;
+
+    static std::atomic<Telemetry *> active_;
+    static std::atomic<std::uint64_t> ninstances_;
+
+public:
+    Telemetry() = delete;
+    /** the telemetry of the program appname for total events. */
+    Telemetry(const std::string &appname, const std::uint64_t total);
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+    ~Telemetry();
+
+    /** counts the weight of an event in the active telemetry, if any. */
+    static void record(const double w) {
+        Telemetry *tel = active_.load(std::memory_order_relaxed);
+        if (tel) { tel->add(w); }
+    }
+
+    /** writes the current state to stderr and the status file. */
+    void report();
+
+private:
+    void add(const double w) {
+        // the threads are numbered in each instance at their first event.
+        thread_local std::uint64_t instance = 0;
+        thread_local unsigned int id = 0;
+        if (instance != instance_) {
+            instance = instance_;
+            id = nthreads_.fetch_add(1, std::memory_order_relaxed);
+        }
+        Counter &c = counters_[id % MAXTHREADS];
+        if (id < MAXTHREADS) {
+            // the counter is written only by its own thread.
+            c.n.store(c.n.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+            c.sum_w.store(c.sum_w.load(std::memory_order_relaxed) + w,
+                          std::memory_order_relaxed);
+            c.sum_w_sq.store(
+                c.sum_w_sq.load(std::memory_order_relaxed) + w * w,
+                std::memory_order_relaxed);
+        } else {
+            // beyond MAXTHREADS, the counter is shared with another thread.
+            c.n.fetch_add(1, std::memory_order_relaxed);
+            addShared(&c.sum_w, w);
+            addShared(&c.sum_w_sq, w * w);
+        }
+    }
+
+    static void addShared(std::atomic<double> *x, const double w) {
+        double old = x->load(std::memory_order_relaxed);
+        while (!x->compare_exchange_weak(old, old + w,
+                                         std::memory_order_relaxed)) {
+        }
+    }
+
+    void run();
+};
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_TELEMETRY_H_
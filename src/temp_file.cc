@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "temp_file.h"
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace fchiggs {
+namespace {
+/**
+ *  `.tmp.<host>.', which marks the temporary files of the jobs on this
+ *  host. The directory may be shared by several hosts, and the process ids
+ *  of the others say nothing here.
+ */
+const std::string &tempMark() {
+    static const std::string mark = [] {
+        char host[256] = {0};
+        if (::gethostname(host, sizeof host - 1) != 0) { host[0] = '\0'; }
+        return ".tmp." + std::string{host} + '.';
+    }();
+    return mark;
+}
+
+bool writeAll(const int fd, const unsigned char *p, const std::size_t n) {
+    std::size_t done = 0;
+    while (done < n) {
+        const ssize_t nw = ::write(fd, p + done, n - done);
+        if (nw < 0) {
+            if (errno == EINTR) { continue; }
+            return false;
+        }
+        done += nw;
+    }
+    return true;
+}
+}  // namespace
+
+bool writeFile(const std::string &path, const void *p, const std::size_t n,
+               const Placement &placement) {
+    std::string tmp =
+        path + tempMark() + std::to_string(::getpid()) + ".XXXXXX";
+    const int fd = ::mkstemp(&tmp[0]);
+    if (fd < 0) { return false; }
+    bool ok = ::fchmod(fd, 0644) == 0 &&
+              writeAll(fd, static_cast<const unsigned char *>(p), n) &&
+              ::fsync(fd) == 0;
+    ::close(fd);
+    if (ok && placement == Placement::Replace) {
+        ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    } else if (ok) {
+        // link fails on an existing file instead of replacing it.
+        ok = ::link(tmp.c_str(), path.c_str()) == 0 || errno == EEXIST;
+    }
+    if (!ok || placement == Placement::Create) { ::unlink(tmp.c_str()); }
+    return ok;
+}
+
+void sweepTemporaries(const std::string &dir, const std::string &prefix) {
+    DIR *d = ::opendir(dir.c_str());
+    if (!d) { return; }
+    const std::string &mark = tempMark();
+    while (const dirent *e = ::readdir(d)) {
+        const std::string name{e->d_name};
+        const auto at = name.rfind(mark);
+        if (name.compare(0, prefix.size(), prefix) != 0 ||
+            at == std::string::npos || at < prefix.size()) {
+            continue;
+        }
+        char *end = nullptr;
+        const long pid = std::strtol(name.c_str() + at + mark.size(), &end, 10);
+        // a live job, even of another user (EPERM), keeps its file.
+        if (pid > 0 && *end == '.' && ::kill(pid, 0) != 0 &&
+            errno == ESRCH) {
+            ::unlink((dir + '/' + name).c_str());
+        }
+    }
+    ::closedir(d);
+}
+}  // namespace fchiggs
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_TEMP_FILE_H_
+#define FCHIGGS_SRC_TEMP_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace fchiggs {
+/** how writeFile puts the file in place. */
+enum class Placement {
+    Replace,  // over the existing file, if any
+    Create    // only if there is none, and an existing one is kept
+};
+
+/**
+ *  Writes the n bytes of p to path through a temporary file next to it, so
+ *  that readers see either the whole file or none. The temporary file is
+ *  `<path>.tmp.<host>.<pid>.XXXXXX', created exclusively with the mode
+ *  0644, since the directory may be writable by anyone. It is removed
+ *  unless the job dies first, and then it is left to sweepTemporaries.
+ *  With Placement::Create, an existing file counts as a success.
+ */
+bool writeFile(const std::string &path, const void *p, const std::size_t n,
+               const Placement &placement);
+
+/**
+ *  Removes the temporary files of writeFile in dir whose names start with
+ *  prefix and whose jobs on this host are gone.
+ */
+void sweepTemporaries(const std::string &dir, const std::string &prefix);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_TEMP_FILE_H_
@@ -7,13 +7,48 @@
  */
 
 #include "utils.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
 #include <random>
 
 namespace fchiggs {
+namespace {
+std::uint64_t initialSeed() {
+    if (const char *seed = std::getenv("FCHIGGS_SEED")) {
+        return std::strtoull(seed, nullptr, 10);
+    }
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+/**
+ *  The seed of the next thread. The first thread uses randomSeed() itself,
+ *  and the others are decorrelated from it by splitmix64.
+ */
+std::uint64_t streamSeed() {
+    static std::atomic<std::uint64_t> stream{0};
+    const std::uint64_t k = stream.fetch_add(1, std::memory_order_relaxed);
+    if (k == 0) { return randomSeed(); }
+    return splitmix64(randomSeed() + k * 0x9e3779b97f4a7c15ULL);
+}
+
+/** mersenne_twistor_engine, one for each thread */
+std::mt19937_64 &generator() {
+    thread_local std::mt19937_64 gen{streamSeed()};
+    return gen;
+}
+}  // namespace
+
+std::uint64_t randomSeed() {
+    static const std::uint64_t seed = initialSeed();
+    return seed;
+}
+
 double getRandom() {
-    static std::random_device rd;
-    static std::mt19937_64 gen{rd()};  // mersenne_twistor_engine
-    static std::uniform_real_distribution<double> dr{0.0, 1.0};
-    return dr(gen);
+    thread_local std::uniform_real_distribution<double> dr{0.0, 1.0};
+    return dr(generator());
 }
+
+void setRandomSeed(const std::uint64_t seed) { generator().seed(seed); }
 }  // namespace fchiggs
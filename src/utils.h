@@ -10,6 +10,7 @@
 #define FCHIGGS_SRC_UTILS_H_
 
 #include <cmath>
+#include <cstdint>
 #include <utility>
 #include "constants.h"
 
@@ -21,15 +22,40 @@ struct ValueType {
     explicit ValueType<T>(const T v) : value(v) {}
 };
 
+/**
+ *  The seed of the random number generator. It is taken from the
+ *  environment variable FCHIGGS_SEED if set.
+ */
+std::uint64_t randomSeed();
+
+/** a uniform variate in [0, 1) from the generator of the calling thread. */
 double getRandom();
 
+/**
+ *  Restarts the generator of the calling thread from the seed, so that the
+ *  following variates are those of a run with that seed.
+ */
+void setRandomSeed(const std::uint64_t seed);
+
+/** the splitmix64 finalizer, which decorrelates nearby seeds. */
+inline std::uint64_t splitmix64(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
 inline double lambda12(const double x, const double y, const double z) {
     double lambda = x * x + y * y + z * z - 2 * x * y - 2 * y * z - 2 * z * x;
     if (lambda < 0) { return std::sqrt(-lambda); }
     return std::sqrt(lambda);
 }
 
-inline double costh(const double delta) { return -1.0 + getRandom() * delta; }
+/** cos(theta) in [-1, -1 + delta) from the uniform variate u in [0, 1). */
+inline double costh(const double delta, const double u) {
+    return -1.0 + u * delta;
+}
+
+inline double costh(const double delta) { return costh(delta, getRandom()); }
 
 inline std::pair<double, double> sigma(const double sum_w,
                                        const double sum_w_sq,
@@ -39,6 +65,20 @@ inline std::pair<double, double> sigma(const double sum_w,
     const double err = std::sqrt(variance / n);  // error
     return std::make_pair(xsec * PBCONV, err * PBCONV);
 }
+
+/**
+ *  sigma from n > 1 independent estimates of the cross section, such as
+ *  the randomizations of QMC. Since n is small, the variance is the
+ *  unbiased one over n - 1.
+ */
+inline std::pair<double, double> sigmaOfEstimates(const double sum,
+                                                  const double sum_sq,
+                                                  const unsigned int n) {
+    const double xsec = sum / n;
+    const double variance = sum_sq / n - xsec * xsec;
+    const double err = std::sqrt(variance / (n - 1.0));
+    return std::make_pair(xsec * PBCONV, err * PBCONV);
+}
 }  // namespace fchiggs
 
 #endif  // FCHIGGS_SRC_UTILS_H_
@@ -0,0 +1,432 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#include "xsec.h"
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "alloc_guard.h"
+#include "constants.h"
+#include "initial_states.h"
+#include "qmc.h"
+#include "strata.h"
+#include "telemetry.h"
+#include "sigma_pph.h"
+#include "sigma_pphb_neutral.h"
+#include "sigma_pphq_charged.h"
+#include "utils.h"
+
+namespace fchiggs {
+namespace {
+/** the width of H in p p --> H. */
+double widthH(const double mh) { return mh / 10000.0; }
+
+/** the lower end of \hat{s} in p p --> H. */
+double shatMinH(const double mh) { return mh * mh / 4.0; }
+}  // namespace
+
+/**
+ *  A Breit-Wigner of a fixed width in \hat{s} times a function of the
+ *  variate u of y, tabulated at NNODE equidistant nodes in [0, 1] and
+ *  interpolated linearly. Its integral is exact: the arctangent for the
+ *  Breit-Wigner and the trapezoidal rule for the interpolant.
+ */
+class ControlVariate {
+public:
+    static constexpr std::size_t NNODE = 1025;
+
+private:
+    double mh2_, mgamma_;
+    std::vector<Grad> h_;
+    Grad integral_;
+
+public:
+    ControlVariate() = delete;
+    /** over [smin, smax] in \hat{s} with d\tau = d\hat{s} / s. */
+    ControlVariate(const double mh, const double gamma, const double smin,
+                   const double smax, const double s, std::vector<Grad> h)
+        : mh2_{mh * mh}, mgamma_{mh * gamma}, h_(std::move(h)) {
+        Grad sum = 0.5 * (h_.front() + h_.back());
+        for (std::size_t k = 1; k + 1 < h_.size(); ++k) { sum += h_[k]; }
+        const double bw = (std::atan((smax - mh2_) / mgamma_) -
+                           std::atan((smin - mh2_) / mgamma_)) /
+                          PI;
+        integral_ = sum * (bw / ((h_.size() - 1) * s));
+    }
+
+    Grad value(const double shat, const double u) const {
+        const double t = u * (h_.size() - 1);
+        const std::size_t k =
+            std::min(static_cast<std::size_t>(t), h_.size() - 2);
+        const Grad h = h_[k] + (t - k) * (h_[k + 1] - h_[k]);
+        const double d = shat - mh2_;
+        return h * (mgamma_ / (PI * (d * d + mgamma_ * mgamma_)));
+    }
+
+    /** in units of the weights. */
+    const Grad &integral() const { return integral_; }
+};
+
+MultiChannel mkChannels(const Process &proc, const double mh,
+                        const double s) {
+    if (proc == Process::H) {
+        return MultiChannel{
+            {{Mapping::BreitWigner, shatMinH(mh), s, mh, mh / 2.0}}};
+    }
+
+    // it's important to set the threshold!!!
+    const double thres = proc == Process::HtCharged ? mh + MT : mh + MB;
+    const double smin = thres * thres;
+    return MultiChannel{{{Mapping::BreitWigner, smin, s, thres, thres},
+                         {Mapping::PowerLaw, smin, s, 1.0},
+                         {Mapping::PowerLaw, smin, s, 2.0},
+                         {Mapping::ThresholdLog, smin, s, 0.1 * smin}}};
+}
+
+template <typename T>
+Subprocesses<T> mkSubprocesses(const Process &proc, const double mh,
+                               const BasicHup<T> &hu, const BasicHdown<T> &hd,
+                               const BasicAngles<T> &ang) {
+    if (proc == Process::Hb) { return subprocesses_hb(mh, hd, ang); }
+    if (proc == Process::HtCharged) {
+        return subprocesses_ht(mh, hu, hd, ang);
+    }
+    if (proc == Process::HbCharged) {
+        return subprocesses_hb_charged(mh, hd, ang);
+    }
+    return Subprocesses<T>{mh};
+}
+
+template Subprocesses<double> mkSubprocesses(const Process &, const double,
+                                             const Hup &, const Hdown &,
+                                             const Angles &);
+template Subprocesses<Grad> mkSubprocesses(const Process &, const double,
+                                           const BasicHup<Grad> &,
+                                           const BasicHdown<Grad> &,
+                                           const BasicAngles<Grad> &);
+
+double Production::weight() const {
+    return weight({getRandom(), getRandom()});
+}
+
+double Production::weight(const Uniforms &u) const {
+    const double shat = channels_.shat(u.rho);
+    const double g = channels_.density(shat);
+    // d\tau = d\hat{s} / s
+    double w = 0;
+    if (g > 0) {
+        w = dsigma(shat, u);
+        if (control_) { w -= control_->value(shat, u.y).value(); }
+        w /= s_ * g;
+    }
+    if (control_) { w += control_->integral().value(); }
+    Telemetry::record(w);
+    return w;
+}
+
+Grad Production::weightGrad(const Uniforms &u) const {
+    const double shat = channels_.shat(u.rho);
+    const double g = channels_.density(shat);
+    const InitPartons p{s_, shat, u.y};
+    Grad w;
+    if (g > 0) {
+        w = dsigma(*pdf_, p, ang_grad_, hu_grad_, hd_grad_, subs_grad_);
+        if (control_) { w -= control_->value(shat, u.y); }
+        w /= s_ * g;
+    }
+    if (control_) { w += control_->integral(); }
+    Telemetry::record(w.value());
+    return w;
+}
+
+void Production::adaptChannels(const unsigned int n,
+                               const unsigned int niter) {
+    if (channels_.size() < 2) { return; }
+
+    std::vector<double> w(channels_.size());
+    for (unsigned int iter = 0; iter != niter; ++iter) {
+        std::fill(w.begin(), w.end(), 0.0);
+        const AllocGuard guard{"adaptChannels"};
+        for (unsigned int itry = 0; itry != n; ++itry) {
+            const Uniforms u{getRandom(), getRandom()};
+            const double shat = channels_.shat(u.rho);
+            const double g = channels_.density(shat);
+            if (g <= 0) {
+                Telemetry::record(0);
+                continue;
+            }
+            const double wgt = dsigma(shat, u) / (s_ * g);
+            Telemetry::record(wgt);
+            for (std::size_t i = 0; i != w.size(); ++i) {
+                w[i] += channels_.density(i, shat) / g * wgt * wgt;
+            }
+        }
+        channels_.adapt(w);
+    }
+}
+
+void Production::addControlVariate() {
+    if (!controlVariateAvailable()) { return; }
+
+    // the weights at the peak divided by the Breit-Wigner there.
+    const double mh2 = mh_ * mh_, gamma = widthH(mh_);
+    std::vector<Grad> h(ControlVariate::NNODE);
+    for (std::size_t k = 0; k != h.size(); ++k) {
+        const InitPartons p{s_, mh2, static_cast<double>(k) / (h.size() - 1)};
+        h[k] = dsigma(*pdf_, p, ang_grad_, hu_grad_, hd_grad_, subs_grad_) *
+               (PI * mh_ * gamma);
+    }
+    control_ = std::make_shared<const ControlVariate>(
+        mh_, gamma, shatMinH(mh_), s_, s_, std::move(h));
+}
+
+double Production::controlIntegral() const {
+    return control_ ? control_->integral().value() : 0;
+}
+
+double Production::dsigma(const double shat, const Uniforms &u) const {
+    return dsigma(*pdf_, InitPartons{s_, shat, u.y});
+}
+
+double Production::dsigma(const PartonDensity &pdf,
+                          const InitPartons &p) const {
+    return dsigma(pdf, p, ang_, hu_, hd_, subs_);
+}
+
+template <typename T>
+T Production::dsigma(const PartonDensity &pdf, const InitPartons &p,
+                     const BasicAngles<T> &ang, const BasicHup<T> &hu,
+                     const BasicHdown<T> &hd,
+                     const Subprocesses<T> &subs) const {
+    if (proc_ == Process::H) {
+        if (!cuts_.accept(p.y())) { return T{}; }
+        return dsigma_h(pdf, p, mu_, mh_, widthH(mh_), alpha_s_, hu, hd, ang,
+                        KGG) *
+               p.delta_y();
+    }
+    return subs.sigma(pdf, p, mu_, alpha_s_, cuts_) * p.delta_y();
+}
+
+std::pair<double, double> xsec(const Production &prod, const unsigned int n) {
+    double sum_w = 0, sum_w_sq = 0;
+    const AllocGuard guard{"xsec"};
+    for (unsigned int itry = 0; itry != n; ++itry) {
+        const double w = prod.weight();
+        sum_w += w;
+        sum_w_sq += w * w;
+    }
+    return sigma(sum_w, sum_w_sq, n);
+}
+
+std::pair<double, double> xsec_qmc(const Production &prod, const unsigned int n,
+                                   const unsigned int nrand) {
+    Sobol sobol{prod.dim()};
+    double u[Sobol::MAXDIM] = {0.0};
+    double sum = 0, sum_sq = 0;
+    for (unsigned int irand = 0; irand != nrand; ++irand) {
+        sobol.randomize();
+        double sum_w = 0;
+        const AllocGuard guard{"xsec_qmc"};
+        for (unsigned int ipt = 0; ipt != n; ++ipt) {
+            sobol.next(u);
+            sum_w += prod.weight({u[0], u[1]});
+        }
+        const double estimate = sum_w / n;
+        sum += estimate;
+        sum_sq += estimate * estimate;
+    }
+    // each randomization is a single unbiased estimate.
+    return sigmaOfEstimates(sum, sum_sq, nrand);
+}
+
+std::pair<double, double> xsec_stratified(const Production &prod,
+                                          const unsigned int n,
+                                          const unsigned int niter,
+                                          std::ostream *diag) {
+    Strata strata{prod.dim(), NSTRATABINS};
+    double u[2] = {0.0};
+    for (unsigned int iter = 0; iter != niter; ++iter) {
+        const auto alloc = strata.allocate(n / niter);
+        const AllocGuard guard{"xsec_stratified"};
+        for (std::size_t i = 0; i != strata.size(); ++i) {
+            for (unsigned long j = 0; j != alloc[i]; ++j) {
+                strata.point(i, u);
+                strata.add(i, prod.weight({u[0], u[1]}));
+            }
+        }
+        strata.endPass();
+    }
+    if (diag) { strata.print(*diag, PBCONV); }
+
+    const auto result = strata.estimate();
+    return std::make_pair(result.first * PBCONV, result.second * PBCONV);
+}
+
+Method integrationMethod() {
+    const char *method = std::getenv("FCHIGGS_INTEGRATOR");
+    if (!method) { return Method::MC; }
+    const std::string name{method};
+    if (name == "qmc") { return Method::QMC; }
+    if (name == "stratified") { return Method::Stratified; }
+    return Method::MC;
+}
+
+std::string methodLabel(const Method &method) {
+    if (method == Method::QMC) { return " by QMC"; }
+    if (method == Method::Stratified) { return " by stratified sampling"; }
+    return "";
+}
+
+bool useControlVariates() {
+    return std::getenv("FCHIGGS_CONTROL_VARIATE") != nullptr;
+}
+
+std::pair<double, double> integrate(const Production &prod,
+                                    const unsigned int n, const Method &method,
+                                    std::ostream *diag) {
+    Production tuned{prod};
+    unsigned int nevent = n;
+    if (tuned.channels().size() > 1) {
+        const auto nwarmup = static_cast<unsigned int>(WARMUP * n);
+        tuned.adaptChannels(nwarmup / NWARMUPITER, NWARMUPITER);
+        nevent -= nwarmup;
+        if (diag) { tuned.channels().print(*diag); }
+    }
+    if (useControlVariates()) { tuned.addControlVariate(); }
+
+    if (method == Method::QMC) {
+        return xsec_qmc(tuned, nevent / NRAND, NRAND);
+    }
+    if (method == Method::Stratified) {
+        return xsec_stratified(tuned, nevent, NSTRATAITER, diag);
+    }
+    return xsec(tuned, nevent);
+}
+
+unsigned int sampledEvents(const Production &prod, const unsigned int n,
+                           const Method &method) {
+    unsigned int nevent = n;
+    if (prod.channels().size() > 1) {
+        nevent -= static_cast<unsigned int>(WARMUP * n);
+    }
+    return method == Method::QMC ? nevent / NRAND * NRAND : nevent;
+}
+
+namespace {
+/** the weight and its derivatives as the components of the gradient. */
+constexpr std::size_t NCOMP = 3;
+
+std::array<double, NCOMP> components(const Grad &w) {
+    return {{w.value(), w.d(0), w.d(1)}};
+}
+
+XsecGradient toGradient(const std::array<std::pair<double, double>, NCOMP> &r) {
+    return {r[0], r[1], r[2]};
+}
+
+XsecGradient xsec_gradient(const Production &prod, const unsigned int n) {
+    std::array<double, NCOMP> sum_w{}, sum_w_sq{};
+    const AllocGuard guard{"xsec_gradient"};
+    for (unsigned int itry = 0; itry != n; ++itry) {
+        const auto w = components(
+            prod.weightGrad({getRandom(), getRandom()}));
+        for (std::size_t i = 0; i != NCOMP; ++i) {
+            sum_w[i] += w[i];
+            sum_w_sq[i] += w[i] * w[i];
+        }
+    }
+    std::array<std::pair<double, double>, NCOMP> result;
+    for (std::size_t i = 0; i != NCOMP; ++i) {
+        result[i] = sigma(sum_w[i], sum_w_sq[i], n);
+    }
+    return toGradient(result);
+}
+
+XsecGradient xsec_qmc_gradient(const Production &prod, const unsigned int n,
+                               const unsigned int nrand) {
+    Sobol sobol{prod.dim()};
+    double u[Sobol::MAXDIM] = {0.0};
+    std::array<double, NCOMP> sum{}, sum_sq{};
+    for (unsigned int irand = 0; irand != nrand; ++irand) {
+        sobol.randomize();
+        std::array<double, NCOMP> sum_w{};
+        const AllocGuard guard{"xsec_qmc_gradient"};
+        for (unsigned int ipt = 0; ipt != n; ++ipt) {
+            sobol.next(u);
+            const auto w = components(prod.weightGrad({u[0], u[1]}));
+            for (std::size_t i = 0; i != NCOMP; ++i) { sum_w[i] += w[i]; }
+        }
+        for (std::size_t i = 0; i != NCOMP; ++i) {
+            const double estimate = sum_w[i] / n;
+            sum[i] += estimate;
+            sum_sq[i] += estimate * estimate;
+        }
+    }
+    std::array<std::pair<double, double>, NCOMP> result;
+    for (std::size_t i = 0; i != NCOMP; ++i) {
+        result[i] = sigmaOfEstimates(sum[i], sum_sq[i], nrand);
+    }
+    return toGradient(result);
+}
+
+/** the strata are allocated by the variance of the cross section. */
+XsecGradient xsec_stratified_gradient(const Production &prod,
+                                      const unsigned int n,
+                                      const unsigned int niter) {
+    std::array<Strata, NCOMP> strata{{{prod.dim(), NSTRATABINS},
+                                      {prod.dim(), NSTRATABINS},
+                                      {prod.dim(), NSTRATABINS}}};
+    double u[2] = {0.0};
+    for (unsigned int iter = 0; iter != niter; ++iter) {
+        const auto alloc = strata[0].allocate(n / niter);
+        const AllocGuard guard{"xsec_stratified_gradient"};
+        for (std::size_t i = 0; i != strata[0].size(); ++i) {
+            for (unsigned long j = 0; j != alloc[i]; ++j) {
+                strata[0].point(i, u);
+                const auto w = components(prod.weightGrad({u[0], u[1]}));
+                for (std::size_t k = 0; k != NCOMP; ++k) {
+                    strata[k].add(i, w[k]);
+                }
+            }
+        }
+        for (auto &st : strata) { st.endPass(); }
+    }
+    std::array<std::pair<double, double>, NCOMP> result;
+    for (std::size_t i = 0; i != NCOMP; ++i) {
+        const auto r = strata[i].estimate();
+        result[i] = {r.first * PBCONV, r.second * PBCONV};
+    }
+    return toGradient(result);
+}
+}  // namespace
+
+XsecGradient integrate_gradient(const Production &prod, const unsigned int n,
+                                const Method &method) {
+    Production tuned{prod};
+    unsigned int nevent = n;
+    if (tuned.channels().size() > 1) {
+        const auto nwarmup = static_cast<unsigned int>(WARMUP * n);
+        tuned.adaptChannels(nwarmup / NWARMUPITER, NWARMUPITER);
+        nevent -= nwarmup;
+    }
+    if (useControlVariates()) { tuned.addControlVariate(); }
+
+    if (method == Method::QMC) {
+        return xsec_qmc_gradient(tuned, nevent / NRAND, NRAND);
+    }
+    if (method == Method::Stratified) {
+        return xsec_stratified_gradient(tuned, nevent, NSTRATAITER);
+    }
+    return xsec_gradient(tuned, nevent);
+}
+}  // namespace fchiggs
@@ -0,0 +1,267 @@
+/*
+ *  Copyright (C) 2017 Chan Beom Park <cbpark@gmail.com>
+ *
+ *  This file is part of fcHiggs, which is released under the GNU General
+ *  Public License. See file LICENSE in the top directory of this project
+ *  or go to <http://www.gnu.org/licenses/> for full license details.
+ */
+
+#ifndef FCHIGGS_SRC_XSEC_H_
+#define FCHIGGS_SRC_XSEC_H_
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include "alpha_s.h"
+#include "angles.h"
+#include "couplings.h"
+#include "cuts.h"
+#include "dual.h"
+#include "initial_states.h"
+#include "multichannel.h"
+#include "pdf.h"
+#include "sigma_pphq.h"
+
+namespace fchiggs {
+/**
+ *  The production processes.
+ *
+ *  H:         p p --> H
+ *  Hb:        p p --> H b
+ *  HtCharged: p p --> H^\pm t
+ *  HbCharged: p p --> H^\pm b
+ */
+enum class Process { H, Hb, HtCharged, HbCharged };
+
+/** whether the Higgs boson of the process is neutral. */
+inline bool neutralHiggs(const Process &proc) {
+    return proc == Process::H || proc == Process::Hb;
+}
+
+/** K factor for g g --> H */
+constexpr double KGG = 2.5;
+
+/**
+ *  The uniform variates in [0, 1) of rho and y. cos(theta) of the 2 --> 2
+ *  processes is integrated analytically.
+ */
+struct Uniforms {
+    double rho, y;
+};
+
+/**
+ *  The \hat{s} mappings of each process. p p --> H uses the Breit-Wigner
+ *  map around m_H. The 2 --> 2 processes combine the Breit-Wigner map at the
+ *  threshold with power-law (nu = 1, 2) and threshold-log maps.
+ */
+MultiChannel mkChannels(const Process &proc, const double mh, const double s);
+
+/** the q g --> q' H subprocesses of the process, none for p p --> H. */
+template <typename T>
+Subprocesses<T> mkSubprocesses(const Process &proc, const double mh,
+                               const BasicHup<T> &hu, const BasicHdown<T> &hd,
+                               const BasicAngles<T> &ang);
+
+class ControlVariate;
+
+/**
+ *  The integrand of p p --> H (+ q) at a given parameter point.
+ *
+ *  The renormalization and factorization scales are set to m_H. The
+ *  events outside the fiducial cuts have zero weight.
+ */
+class Production {
+private:
+    Process proc_;
+    std::shared_ptr<PartonDensity> pdf_;
+    double s_, mh_;
+    Angles ang_;
+    Hup hu_;
+    Hdown hd_;
+    // the same couplings with the derivatives.
+    BasicAngles<Grad> ang_grad_;
+    BasicHup<Grad> hu_grad_;
+    BasicHdown<Grad> hd_grad_;
+    Subprocesses<double> subs_;
+    Subprocesses<Grad> subs_grad_;
+    MultiChannel channels_;
+    double mu_, alpha_s_;
+    FiducialCuts cuts_;
+    /** immutable, and so shared by the copies. */
+    std::shared_ptr<const ControlVariate> control_;
+
+public:
+    Production() = delete;
+    Production(const Process &proc, std::shared_ptr<PartonDensity> pdf,
+               const double s, const double mh, const Angles &ang,
+               const FiducialCuts &cuts = {})
+        : proc_(proc),
+          pdf_(pdf),
+          s_(s),
+          mh_(mh),
+          ang_(ang),
+          hu_(ang, Y33U),
+          hd_(ang),
+          ang_grad_(Grad{ang.tan_beta(), 0}, Grad{ang.cos_alpha_beta(), 1}),
+          hu_grad_(ang_grad_, Y33U),
+          hd_grad_(ang_grad_),
+          subs_(mkSubprocesses(proc, mh, hu_, hd_, ang_)),
+          subs_grad_(mkSubprocesses(proc, mh, hu_grad_, hd_grad_, ang_grad_)),
+          channels_(mkChannels(proc, mh, s)),
+          mu_(mh),
+          alpha_s_(alphaS()(mu_)),
+          cuts_(cuts) {}
+
+    Process process() const { return proc_; }
+    std::shared_ptr<PartonDensity> pdf() const { return pdf_; }
+    double s() const { return s_; }
+    double mh() const { return mh_; }
+    const Angles &angles() const { return ang_; }
+    double mu() const { return mu_; }
+    double alpha_s() const { return alpha_s_; }
+    const FiducialCuts &cuts() const { return cuts_; }
+
+    /** the number of integration variables. */
+    unsigned int dim() const { return 2; }
+
+    /** the weight of a single event in units of GeV^{-2}. */
+    double weight() const;
+
+    /** the weight at the given point of the unit hypercube. */
+    double weight(const Uniforms &u) const;
+
+    /**
+     *  The same weight with its derivatives with respect to tan(beta) and
+     *  cos(alpha-beta), always in double precision.
+     */
+    Grad weightGrad(const Uniforms &u) const;
+
+    /**
+     *  The weight at the partonic point apart from the density of \hat{s},
+     *  with the densities of pdf in place of its own. The productions that
+     *  share a point may thus share the densities at it.
+     */
+    double dsigma(const PartonDensity &pdf, const InitPartons &p) const;
+
+    const MultiChannel &channels() const { return channels_; }
+
+    /**
+     *  Tunes the weights of the \hat{s} channels to minimize the variance
+     *  with niter iterations of n events.
+     */
+    void adaptChannels(const unsigned int n, const unsigned int niter);
+
+    /**
+     *  Subtracts a control variate from the weights and adds back its
+     *  exact integral, so that the weights have the same mean with a
+     *  smaller variance. p p --> H has the narrow-width approximation: the
+     *  Breit-Wigner of a fixed width times the weight at \hat{s} = m_H^2,
+     *  tabulated in the variate of y. The 2 --> 2 processes have none.
+     */
+    void addControlVariate();
+    /** whether addControlVariate adds one to this process. */
+    bool controlVariateAvailable() const { return proc_ == Process::H; }
+    bool hasControlVariate() const { return control_ != nullptr; }
+    /**
+     *  The exact integral of the control variate in units of the weights,
+     *  or zero without one.
+     */
+    double controlIntegral() const;
+
+private:
+    /** the weight at \hat{s} apart from the density of \hat{s}. */
+    double dsigma(const double shat, const Uniforms &u) const;
+
+    template <typename T>
+    T dsigma(const PartonDensity &pdf, const InitPartons &p,
+             const BasicAngles<T> &ang, const BasicHup<T> &hu,
+             const BasicHdown<T> &hd, const Subprocesses<T> &subs) const;
+};
+
+/** the cross section and its error in pb from n events. */
+std::pair<double, double> xsec(const Production &prod, const unsigned int n);
+
+/**
+ *  The cross section and its error in pb from nrand independent
+ *  randomizations of the scrambled Sobol sequence with n points each.
+ *  n is preferably a power of two.
+ */
+std::pair<double, double> xsec_qmc(const Production &prod, const unsigned int n,
+                                   const unsigned int nrand);
+
+/**
+ *  The cross section and its error in pb from about n events sampled in
+ *  strata of the unit hypercube. The events are allocated to the strata in
+ *  niter passes, the first uniformly and the others in proportion to the
+ *  standard deviations of the weights in the strata. If diag is not null,
+ *  the per-stratum estimates are written to it.
+ */
+std::pair<double, double> xsec_stratified(const Production &prod,
+                                          const unsigned int n,
+                                          const unsigned int niter,
+                                          std::ostream *diag);
+
+/**
+ *  The integration methods. The drivers take it from the environment
+ *  variable FCHIGGS_INTEGRATOR (`mc', `qmc' or `stratified'), and `mc' is
+ *  the default.
+ */
+enum class Method { MC, QMC, Stratified };
+
+Method integrationMethod();
+
+/** " by <method>" for the messages of the drivers. */
+std::string methodLabel(const Method &method);
+
+/**
+ *  Whether integrate and integrate_gradient add the control variates,
+ *  which the environment variable FCHIGGS_CONTROL_VARIATE turns on.
+ */
+bool useControlVariates();
+
+/** the number of randomizations in the QMC integration. */
+constexpr unsigned int NRAND = 16;
+
+/** the number of allocation passes in the stratified sampling. */
+constexpr unsigned int NSTRATAITER = 5;
+/** the bins on each axis of the stratified sampling, 256 strata. */
+constexpr unsigned int NSTRATABINS = 16;
+
+/** the fraction of events for the warm-up of the channel weights. */
+constexpr double WARMUP = 0.1;
+constexpr unsigned int NWARMUPITER = 5;
+
+/**
+ *  The cross section and its error in pb from about n weights. If the
+ *  process has several \hat{s} channels, their weights are tuned with a
+ *  fraction WARMUP of the events first. The diagnostics, such as the
+ *  channel weights, are written to diag unless it is null.
+ */
+std::pair<double, double> integrate(const Production &prod,
+                                    const unsigned int n, const Method &method,
+                                    std::ostream *diag = nullptr);
+
+/**
+ *  The number of weights that integrate samples for the estimate from n,
+ *  without the warm-up of the channel weights.
+ */
+unsigned int sampledEvents(const Production &prod, const unsigned int n,
+                           const Method &method);
+
+/** the cross section and its derivatives, each with its error in pb. */
+struct XsecGradient {
+    std::pair<double, double> sigma;
+    std::pair<double, double> d_tan_beta, d_cos_alpha_beta;
+};
+
+/**
+ *  The cross section with its derivatives with respect to tan(beta) and
+ *  cos(alpha-beta) from the same n events as in integrate. The errors of
+ *  the derivatives are correlated with that of the cross section.
+ */
+XsecGradient integrate_gradient(const Production &prod, const unsigned int n,
+                                const Method &method);
+}  // namespace fchiggs
+
+#endif  // FCHIGGS_SRC_XSEC_H_